@@ -24,6 +24,15 @@ inline void serialize(Archive &archive,
           cereal::make_nvp("S", block_sym.S));
 }
 
+template <typename Archive, typename Solver>
+inline void serialize(Archive &archive,
+                      albatross::AppendedBlockSymmetric<Solver> &block_sym,
+                      const std::uint32_t) {
+  archive(cereal::make_nvp("A", block_sym.A),
+          cereal::make_nvp("Ai_Bs", block_sym.Ai_Bs),
+          cereal::make_nvp("Ss", block_sym.Ss));
+}
+
 } // namespace cereal
 
 #endif /* ALBATROSS_SRC_CEREAL_BLOCK_UTILS_HPP_ */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_SRC_CEREAL_FIT_DELTA_HPP_
+#define ALBATROSS_SRC_CEREAL_FIT_DELTA_HPP_
+
+/*
+ * A delta log is a stream of independently serialized GPFitDelta
+ * records.  Typical use for an online model is to occasionally write a
+ * full snapshot of the (compacted) fit, then append a delta to the log
+ * after each update, opening the file with std::ios::app so nothing that
+ * has already been written is touched.  On load the deltas are replayed
+ * on top of the snapshot, and once the log gets long the fit is
+ * compacted into a new snapshot and the log is truncated.
+ */
+
+namespace albatross {
+
+template <typename FeatureType>
+inline void append_fit_delta(std::ostream &stream,
+                             const GPFitDelta<FeatureType> &delta) {
+  cereal::BinaryOutputArchive archive(stream);
+  archive(delta);
+}
+
+/*
+ * Applies every delta remaining in the stream to the fit and returns
+ * how many were applied.
+ */
+template <typename Solver, typename FeatureType>
+inline std::size_t replay_fit_deltas(
+    std::istream &stream,
+    Fit<GPFit<AppendedBlockSymmetric<Solver>, FeatureType>> *fit) {
+  std::size_t count = 0;
+  while (stream.peek() != std::char_traits<char>::eof()) {
+    GPFitDelta<FeatureType> delta;
+    cereal::BinaryInputArchive archive(stream);
+    archive(delta);
+    apply_fit_delta(delta, fit);
+    ++count;
+  }
+  return count;
+}
+
+} // namespace albatross
+
+#endif /* ALBATROSS_SRC_CEREAL_FIT_DELTA_HPP_ */
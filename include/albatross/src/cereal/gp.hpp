@@ -16,6 +16,7 @@
 using albatross::Fit;
 using albatross::GaussianProcessBase;
 using albatross::GPFit;
+using albatross::GPFitDelta;
 using albatross::SparseGPFit;
 
 #ifndef GP_SERIALIZATION_VERSION
@@ -34,6 +35,15 @@ inline void serialize(Archive &archive,
   archive(cereal::make_nvp("train_features", fit.train_features));
 }
 
+template <typename Archive, typename FeatureType>
+inline void serialize(Archive &archive, GPFitDelta<FeatureType> &delta,
+                      const std::uint32_t) {
+  archive(cereal::make_nvp("features", delta.features));
+  archive(cereal::make_nvp("Ai_B", delta.Ai_B));
+  archive(cereal::make_nvp("S", delta.S));
+  archive(cereal::make_nvp("Si_delta", delta.Si_delta));
+}
+
 template <typename Archive, typename FeatureType>
 inline void serialize(Archive &archive, Fit<SparseGPFit<FeatureType>> &fit,
                       const std::uint32_t) {
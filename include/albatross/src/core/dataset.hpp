@@ -40,6 +40,13 @@ template <typename FeatureType> struct RegressionDataset {
            static_cast<int>(targets.size()));
   }
 
+  RegressionDataset(std::vector<FeatureType> &&features_,
+                    MarginalDistribution &&targets_)
+      : features(std::move(features_)), targets(std::move(targets_)) {
+    assert(static_cast<int>(features.size()) ==
+           static_cast<int>(targets.size()));
+  }
+
   RegressionDataset(const std::vector<FeatureType> &features_,
                     const Eigen::VectorXd &targets_)
       : RegressionDataset(features_, MarginalDistribution(targets_)) {}
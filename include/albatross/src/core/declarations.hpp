@@ -171,6 +171,14 @@ template <typename InlierMetric, typename ConsensusMetric,
           typename IsValidCandidateMetric, typename GrouperFunction>
 struct GaussianProcessRansacStrategy;
 
+/*
+ * Thinning
+ */
+
+template <typename ModelType, typename StrategyType> class Thinned;
+
+template <typename ModelType, typename FeatureType> struct ThinnedFit;
+
 /*
  * Samplers
  */
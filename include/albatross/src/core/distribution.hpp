@@ -35,6 +35,8 @@ private:
 public:
   DistributionBase(const Eigen::VectorXd &mean_) : mean(mean_){};
 
+  DistributionBase(Eigen::VectorXd &&mean_) : mean(std::move(mean_)){};
+
   std::size_t size() const {
     // If the covariance is defined it must have the same number
     // of rows and columns which should be the same size as the mean.
@@ -82,6 +84,13 @@ struct MarginalDistribution : public DistributionBase<MarginalDistribution> {
     assert_valid();
   }
 
+  template <typename DiagonalDerived>
+  MarginalDistribution(Eigen::VectorXd &&mean_,
+                       const Eigen::DiagonalBase<DiagonalDerived> &covariance_)
+      : Base(std::move(mean_)), covariance(covariance_) {
+    assert_valid();
+  }
+
   MarginalDistribution(const Eigen::VectorXd &mean_,
                        const Eigen::VectorXd &variance_)
       : Base(mean_), covariance(variance_.asDiagonal()) {
@@ -38,8 +38,8 @@ public:
   template <typename PredictFeatureType>
   const PredictionReference<ModelType, PredictFeatureType, Fit>
   predict(const std::vector<PredictFeatureType> &features) const & {
-    return PredictionReference<ModelType, PredictFeatureType, Fit>(model_, fit_,
-                                                                   features);
+    return PredictionReference<ModelType, PredictFeatureType, Fit>(
+        model_, fit_, features, &prediction_cache_);
   }
 
   // When FitModel is an rvalue the Fit will be a temporary so
@@ -82,13 +82,26 @@ public:
 
   template <typename FeatureType,
             typename std::enable_if<
-                can_update_in_place<ModelType, Fit, FeatureType>::value,
+                can_update_in_place<ModelType, Fit, FeatureType>::value &&
+                    !has_valid_update_in_place<ModelType, Fit,
+                                               FeatureType>::value,
                 int>::type = 0>
   void update_in_place(const std::vector<FeatureType> &features,
                        const MarginalDistribution &targets) {
+    prediction_cache_.clear();
     fit_ = model_._update_impl(fit_, features, targets);
   }
 
+  template <typename FeatureType,
+            typename std::enable_if<
+                has_valid_update_in_place<ModelType, Fit, FeatureType>::value,
+                int>::type = 0>
+  void update_in_place(const std::vector<FeatureType> &features,
+                       const MarginalDistribution &targets) {
+    prediction_cache_.clear();
+    model_._update_in_place_impl(&fit_, features, targets);
+  }
+
   template <typename FeatureType>
   void update_in_place(const RegressionDataset<FeatureType> &dataset) {
     update_in_place(dataset.features, dataset.targets);
@@ -96,12 +109,36 @@ public:
 
   Fit get_fit() const { return fit_; }
 
+  // Cached predictions aren't invalidated by modifying the fit or model
+  // through these references, call invalidate_prediction_cache() after
+  // doing so.
   Fit &get_fit() { return fit_; }
 
   ModelType get_model() const { return model_; };
 
   ModelType &get_model() { return model_; };
 
+  /*
+   * Predictions made from an lvalue FitModel can be stored in a bounded
+   * least recently used cache, so repeatedly predicting at the same
+   * features only requires a lookup.  The cache is cleared any time the
+   * fit is updated (see update_in_place()) and only applies to features
+   * which can be compared.
+   */
+  void enable_prediction_cache(std::size_t capacity) {
+    prediction_cache_.set_capacity(capacity);
+  }
+
+  void disable_prediction_cache() { prediction_cache_.set_capacity(0); }
+
+  // Drops any cached predictions, for use after modifying the fit or
+  // model through get_fit() or get_model().
+  void invalidate_prediction_cache() { prediction_cache_.clear(); }
+
+  PredictionCacheStats prediction_cache_stats() const {
+    return prediction_cache_.stats();
+  }
+
   bool operator==(const FitModel &other) const {
     return (model_ == other.model_ && fit_ == other.fit_);
   }
@@ -109,6 +146,7 @@ public:
 private:
   ModelType model_;
   Fit fit_;
+  mutable PredictionCache prediction_cache_;
 };
 
 template <typename ModelType, typename FitType, typename FeatureType>
@@ -43,6 +43,16 @@ protected:
                                                      std::move(fit_output));
   }
 
+  template <typename FeatureType,
+            typename std::enable_if<
+                has_valid_fit<ModelType, FeatureType>::value, int>::type = 0>
+  auto _fit(const std::vector<FeatureType> &features,
+            MarginalDistribution &&targets) const {
+    auto fit_output = derived()._fit_impl(features, std::move(targets));
+    return FitModel<ModelType, decltype(fit_output)>(derived(),
+                                                     std::move(fit_output));
+  }
+
   template <
       typename FeatureType,
       typename std::enable_if<has_possible_fit<ModelType, FeatureType>::value &&
@@ -129,6 +139,18 @@ public:
     return _fit(dataset.features, dataset.targets);
   }
 
+  // Fits using targets which live in caller owned buffers.  The mean and
+  // variance are each copied once into targets owned by the fit, models
+  // which support it (such as a GP) then remove the mean function from
+  // that copy in place.
+  template <typename FeatureType>
+  auto fit(const std::vector<FeatureType> &features,
+           const Eigen::Ref<const Eigen::VectorXd> &mean,
+           const Eigen::Ref<const Eigen::VectorXd> &variance) const {
+    return _fit(features, MarginalDistribution(Eigen::VectorXd(mean),
+                                               variance.asDiagonal()));
+  }
+
   template <typename FeatureX, typename FeatureY>
   auto fit(const RegressionDataset<FeatureX> &x,
            const RegressionDataset<FeatureY> &y) const {
@@ -147,6 +169,9 @@ public:
   Ransac<ModelType, Strategy> ransac(const Strategy &strategy,
                                      const RansacConfig &) const;
 
+  template <typename Strategy>
+  Thinned<ModelType, Strategy> thinned(const Strategy &strategy) const;
+
   Insights insights;
   bool use_async_;
 };
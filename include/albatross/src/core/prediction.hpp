@@ -125,6 +125,10 @@ public:
              const std::vector<FeatureType> &features)
       : model_(std::move(model)), fit_(std::move(fit)), features_(features) {}
 
+  Prediction(const PlainModelType &model, const PlainFitType &fit,
+             const std::vector<FeatureType> &features, PredictionCache *cache)
+      : model_(model), fit_(fit), features_(features), cache_(cache) {}
+
   // Mean
   template <typename DummyType = FeatureType,
             typename std::enable_if<can_predict_mean<MeanPredictor, ModelType,
@@ -133,7 +137,8 @@ public:
   Eigen::VectorXd mean() const {
     static_assert(std::is_same<DummyType, FeatureType>::value,
                   "never do prediction.mean<T>()");
-    return MeanPredictor()._mean(model_, fit_, features_);
+    return cached<Eigen::VectorXd>(
+        [&]() { return MeanPredictor()._mean(model_, fit_, features_); });
   }
 
   template <
@@ -154,7 +159,9 @@ public:
   MarginalDistribution marginal() const {
     static_assert(std::is_same<DummyType, FeatureType>::value,
                   "never do prediction.mean<T>()");
-    return MarginalPredictor()._marginal(model_, fit_, features_);
+    return cached<MarginalDistribution>([&]() {
+      return MarginalPredictor()._marginal(model_, fit_, features_);
+    });
   }
 
   template <typename DummyType = FeatureType,
@@ -175,7 +182,8 @@ public:
   JointDistribution joint() const {
     static_assert(std::is_same<DummyType, FeatureType>::value,
                   "never do prediction.mean<T>()");
-    return JointPredictor()._joint(model_, fit_, features_);
+    return cached<JointDistribution>(
+        [&]() { return JointPredictor()._joint(model_, fit_, features_); });
   }
 
   template <
@@ -187,6 +195,45 @@ public:
       ALBATROSS_FAIL(DummyType, "No valid predict method in ModelType for the "
                                 "joint with FitType and FeatureType.");
 
+  // Grouped Joint
+  template <
+      typename GrouperFunction, typename DummyType = FeatureType,
+      typename std::enable_if<can_predict_joint<JointPredictor, ModelType,
+                                                DummyType, FitType>::value,
+                              int>::type = 0>
+  auto grouped_joint(const GrouperFunction &grouper) const {
+    // Only the diagonal blocks of the joint covariance corresponding to
+    // each group are computed, with the groups predicted in parallel.
+    // There can be thousands of groups so they're handed out to a bounded
+    // number of workers rather than each getting a thread of its own.
+    const auto indexers = group_by(features_, grouper).indexers();
+    const auto keys = indexers.keys();
+    std::vector<JointDistribution> joints(keys.size());
+    std::vector<std::size_t> inds(keys.size());
+    std::iota(inds.begin(), inds.end(), 0);
+    auto predict_group = [&](const std::size_t &i) {
+      joints[i] = JointPredictor()._joint(
+          model_, fit_, subset(features_, indexers.at(keys[i])));
+    };
+    bounded_async_apply(inds, predict_group,
+                        tuning_threads(get_tuning_parameters()));
+
+    Grouped<typename decltype(keys)::value_type, JointDistribution> output;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      output[keys[i]] = std::move(joints[i]);
+    }
+    return output;
+  }
+
+  template <
+      typename GrouperFunction, typename DummyType = FeatureType,
+      typename std::enable_if<!can_predict_joint<JointPredictor, ModelType,
+                                                 DummyType, FitType>::value,
+                              int>::type = 0>
+  void grouped_joint(const GrouperFunction &) const
+      ALBATROSS_FAIL(DummyType, "No valid predict method in ModelType for the "
+                                "joint with FitType and FeatureType.");
+
   template <typename PredictType>
   PredictType get(PredictTypeIdentity<PredictType> =
                       PredictTypeIdentity<PredictType>()) const {
@@ -212,9 +259,29 @@ private:
     return this->joint();
   }
 
+  template <typename PredictType, typename ComputeFunction,
+            typename DummyType = FeatureType,
+            typename std::enable_if<is_equality_comparable<DummyType>::value,
+                                    int>::type = 0>
+  PredictType cached(const ComputeFunction &compute) const {
+    if (cache_ == nullptr) {
+      return compute();
+    }
+    return cache_->get_or_compute<PredictType>(features_, compute);
+  }
+
+  template <typename PredictType, typename ComputeFunction,
+            typename DummyType = FeatureType,
+            typename std::enable_if<!is_equality_comparable<DummyType>::value,
+                                    int>::type = 0>
+  PredictType cached(const ComputeFunction &compute) const {
+    return compute();
+  }
+
   const ModelType model_;
   const FitType fit_;
   const std::vector<FeatureType> features_;
+  PredictionCache *cache_ = nullptr;
 };
 
 template <typename ModelType, typename FeatureType, typename FitType>
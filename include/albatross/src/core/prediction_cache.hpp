@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_CORE_PREDICTION_CACHE_H
+#define ALBATROSS_CORE_PREDICTION_CACHE_H
+
+namespace albatross {
+
+struct PredictionCacheStats {
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+  std::size_t size = 0;
+  std::size_t capacity = 0;
+};
+
+namespace details {
+
+inline std::size_t hash_combine(std::size_t seed, std::size_t value) {
+  return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+template <typename T>
+struct is_std_hashable
+    : public std::integral_constant<bool,
+                                    std::is_arithmetic<T>::value ||
+                                        std::is_same<T, std::string>::value> {
+};
+
+template <typename T> struct is_hashable_eigen : public std::false_type {};
+
+template <typename Scalar, int Rows, int Cols, int Options, int MaxRows,
+          int MaxCols>
+struct is_hashable_eigen<
+    Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>>
+    : public std::is_arithmetic<Scalar> {};
+
+template <typename T>
+struct uses_eigen_hash
+    : public std::integral_constant<bool, !has_hash_value<T>::value &&
+                                              is_hashable_eigen<T>::value> {};
+
+template <typename T>
+struct has_feature_hash
+    : public std::integral_constant<bool, is_std_hashable<T>::value ||
+                                              has_hash_value<T>::value ||
+                                              uses_eigen_hash<T>::value ||
+                                              is_measurement<T>::value ||
+                                              is_variant<T>::value> {};
+
+template <typename T,
+          typename std::enable_if<is_std_hashable<T>::value, int>::type = 0>
+inline std::size_t feature_hash(const T &x) {
+  return std::hash<T>()(x);
+}
+
+template <typename T,
+          typename std::enable_if<!is_std_hashable<T>::value &&
+                                      has_hash_value<T>::value,
+                                  int>::type = 0>
+inline std::size_t feature_hash(const T &x) {
+  return static_cast<std::size_t>(hash_value(x));
+}
+
+template <typename T, typename std::enable_if<uses_eigen_hash<T>::value,
+                                              int>::type = 0>
+inline std::size_t feature_hash(const T &x) {
+  std::size_t seed = hash_combine(static_cast<std::size_t>(x.rows()),
+                                  static_cast<std::size_t>(x.cols()));
+  for (Eigen::Index j = 0; j < x.cols(); ++j) {
+    for (Eigen::Index i = 0; i < x.rows(); ++i) {
+      seed = hash_combine(seed, feature_hash(x(i, j)));
+    }
+  }
+  return seed;
+}
+
+// Features without a hash all land in the same bucket, the cache
+// still compares the features themselves before reporting a hit.
+template <typename T, typename std::enable_if<!has_feature_hash<T>::value,
+                                              int>::type = 0>
+inline std::size_t feature_hash(const T &) {
+  return 0;
+}
+
+template <typename X>
+inline std::size_t feature_hash(const Measurement<X> &x) {
+  return feature_hash(x.value);
+}
+
+template <typename... Ts>
+inline std::size_t feature_hash(const variant<Ts...> &x) {
+  return hash_combine(x.which(), x.match([](const auto &v) {
+    return feature_hash(v);
+  }));
+}
+
+template <typename FeatureType>
+inline std::size_t hash_features(const std::vector<FeatureType> &features) {
+  std::size_t seed = features.size();
+  for (const auto &f : features) {
+    seed = hash_combine(seed, feature_hash(f));
+  }
+  return seed;
+}
+
+} // namespace details
+
+/*
+ * A bounded, least recently used, cache of predictions keyed by the
+ * query features and the type of prediction (mean, marginal or joint).
+ * Entries are indexed by a hash of the features, arithmetic types,
+ * strings, Eigen vectors, measurements and variants of those are hashed
+ * automatically and other feature types can provide a
+ *
+ *   std::size_t hash_value(const FeatureType &);
+ *
+ * which is found by argument dependent lookup.  Feature types without a
+ * hash still work but every lookup compares against all cached entries.
+ *
+ * The cache has no knowledge of the fit it is caching predictions for,
+ * it's the responsibility of the owner (FitModel) to clear it whenever
+ * the fit changes.  A capacity of zero disables caching.
+ */
+class PredictionCache {
+public:
+  PredictionCache() : PredictionCache(0){};
+
+  explicit PredictionCache(std::size_t capacity)
+      : capacity_(capacity), hits_(0), misses_(0), entries_(), index_(){};
+
+  PredictionCache(const PredictionCache &other) : PredictionCache() {
+    *this = other;
+  }
+
+  PredictionCache &operator=(const PredictionCache &other) {
+    if (this != &other) {
+      std::lock(mutex_, other.mutex_);
+      std::lock_guard<std::mutex> lock(mutex_, std::adopt_lock);
+      std::lock_guard<std::mutex> other_lock(other.mutex_, std::adopt_lock);
+      capacity_ = other.capacity_.load();
+      hits_ = other.hits_;
+      misses_ = other.misses_;
+      entries_ = other.entries_;
+      index_.clear();
+      for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        index_.emplace(it->key, it);
+      }
+    }
+    return *this;
+  }
+
+  /*
+   * Returns the cached prediction if one exists otherwise calls compute()
+   * and stores the result.  compute() is called without holding the lock
+   * so concurrent misses don't wait on each other.
+   */
+  template <typename PredictType, typename FeatureType,
+            typename ComputeFunction>
+  PredictType get_or_compute(const std::vector<FeatureType> &features,
+                             const ComputeFunction &compute);
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+  }
+
+  void set_capacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    evict();
+  }
+
+  std::size_t capacity() const { return capacity_; }
+
+  PredictionCacheStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PredictionCacheStats output;
+    output.hits = hits_;
+    output.misses = misses_;
+    output.size = entries_.size();
+    output.capacity = capacity_;
+    return output;
+  }
+
+private:
+  struct Key {
+    std::type_index type;
+    std::size_t hash;
+
+    bool operator==(const Key &other) const {
+      return type == other.type && hash == other.hash;
+    }
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const {
+      return details::hash_combine(key.type.hash_code(), key.hash);
+    }
+  };
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<const void> features;
+    std::shared_ptr<const void> prediction;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  template <typename FeatureType>
+  typename EntryList::iterator find(const Key &key,
+                                    const std::vector<FeatureType> &features) {
+    const auto range = index_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (*std::static_pointer_cast<const std::vector<FeatureType>>(
+              it->second->features) == features) {
+        return it->second;
+      }
+    }
+    return entries_.end();
+  }
+
+  void evict() {
+    while (entries_.size() > capacity_) {
+      const auto last = std::prev(entries_.end());
+      const auto range = index_.equal_range(last->key);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          index_.erase(it);
+          break;
+        }
+      }
+      entries_.pop_back();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  // Atomic so a disabled cache can be skipped without taking the lock.
+  std::atomic<std::size_t> capacity_;
+  std::size_t hits_;
+  std::size_t misses_;
+  // Most recently used entries are at the front.
+  EntryList entries_;
+  std::unordered_multimap<Key, typename EntryList::iterator, KeyHash> index_;
+};
+
+template <typename PredictType, typename FeatureType, typename ComputeFunction>
+inline PredictType
+PredictionCache::get_or_compute(const std::vector<FeatureType> &features,
+                                const ComputeFunction &compute) {
+  static_assert(is_equality_comparable<FeatureType>::value,
+                "Caching predictions requires comparable features");
+
+  // The cache is disabled by default, in which case predictions shouldn't
+  // pay for hashing the features or locking.
+  if (capacity_ == 0) {
+    return compute();
+  }
+
+  // The feature type is included since different feature types could
+  // otherwise produce the same hash.
+  const Key key{std::type_index(typeid(std::pair<FeatureType, PredictType>)),
+                details::hash_features(features)};
+
+  bool enabled = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled = capacity_ > 0;
+    if (enabled) {
+      const auto it = find(key, features);
+      if (it != entries_.end()) {
+        ++hits_;
+        entries_.splice(entries_.begin(), entries_, it);
+        return *std::static_pointer_cast<const PredictType>(it->prediction);
+      }
+      ++misses_;
+    }
+  }
+
+  if (!enabled) {
+    return compute();
+  }
+
+  const auto prediction = std::make_shared<const PredictType>(compute());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another thread may have computed the same prediction in the meantime.
+  if (capacity_ > 0 && find(key, features) == entries_.end()) {
+    entries_.push_front(
+        Entry{key, std::make_shared<const std::vector<FeatureType>>(features),
+              prediction});
+    index_.emplace(key, entries_.begin());
+    evict();
+  }
+  return *prediction;
+}
+
+} // namespace albatross
+#endif
@@ -247,6 +247,30 @@ struct can_update_in_place {
                               FeatureType>::can_update_in_place;
 };
 
+/*
+ * Models whose fits are expensive to copy can also provide,
+ *
+ *   void _update_in_place_impl(FitType *fit,
+ *                              const std::vector<FeatureType> &features,
+ *                              const MarginalDistribution &targets) const;
+ *
+ * which FitModel::update_in_place will use instead of _update_impl.
+ */
+template <typename T, typename FitType, typename FeatureType>
+class has_valid_update_in_place {
+  template <typename C,
+            typename ReturnType =
+                decltype(std::declval<const C>()._update_in_place_impl(
+                    std::declval<FitType *>(),
+                    std::declval<const std::vector<FeatureType> &>(),
+                    std::declval<const MarginalDistribution &>()))>
+  static std::true_type test(C *);
+  template <typename> static std::false_type test(...);
+
+public:
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
 /*
  * Determines the type of updated_fit in a call along the lines of :
  *
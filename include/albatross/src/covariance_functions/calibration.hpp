@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_COVARIANCE_FUNCTIONS_CALIBRATION_H
+#define ALBATROSS_COVARIANCE_FUNCTIONS_CALIBRATION_H
+
+/*
+ * Short micro benchmarks of the blocked covariance assembly kernels used
+ * to pick TuningParameters for the current machine, see tuning.hpp.
+ * With the default options calibration takes well under a second.
+ */
+
+namespace albatross {
+
+struct CalibrationOptions {
+  // Number of features used when timing the distance kernels.
+  std::size_t size = 512;
+  // Each timing is the fastest of this many runs.
+  std::size_t repeats = 3;
+  // Feature dimensions at which the Gram assembly is compared to the
+  // pairwise loop.
+  std::vector<Eigen::Index> dimensions = {2, 4, 8, 16, 32, 64};
+  // Candidate numbers of elements per parallel block.
+  std::vector<Eigen::Index> block_sizes = {1 << 14, 1 << 16, 1 << 18};
+};
+
+namespace details {
+
+inline std::vector<Eigen::VectorXd>
+calibration_features(std::size_t n, Eigen::Index dimension) {
+  std::mt19937 gen(2020);
+  std::normal_distribution<double> normal(0., 1.);
+  std::vector<Eigen::VectorXd> features;
+  for (std::size_t i = 0; i < n; ++i) {
+    Eigen::VectorXd x(dimension);
+    for (Eigen::Index j = 0; j < dimension; ++j) {
+      x[j] = normal(gen);
+    }
+    features.push_back(x);
+  }
+  return features;
+}
+
+template <typename Function>
+inline double fastest_time(const Function &f, std::size_t repeats) {
+  double fastest = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < std::max(repeats, std::size_t(1)); ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const auto end = std::chrono::steady_clock::now();
+    fastest =
+        std::min(fastest, std::chrono::duration<double>(end - start).count());
+  }
+  return fastest;
+}
+
+/*
+ * The parameters used by the kernels are passed explicitly, the global
+ * parameters may be in the middle of being resolved.
+ */
+inline double time_gram_distances(const std::vector<Eigen::VectorXd> &xs,
+                                  const TuningParameters &params,
+                                  std::size_t repeats) {
+  const Eigen::VectorXd center =
+      Eigen::VectorXd::Zero(details::common_dimension(xs));
+  const Eigen::MatrixXd packed = pack_coordinates(xs, center);
+  const auto identity = [](double d) { return d; };
+  const auto assemble = [&]() {
+    transformed_gram_distances(packed, packed, true, identity, params);
+  };
+  return fastest_time(assemble, repeats);
+}
+
+inline double time_pairwise_distances(const std::vector<Eigen::VectorXd> &xs,
+                                      std::size_t repeats) {
+  const EuclideanDistance distance;
+  return fastest_time([&]() { compute_covariance_matrix(distance, xs); },
+                      repeats);
+}
+
+} // namespace details
+
+inline TuningParameters
+calibrate_tuning_parameters(const CalibrationOptions &options) {
+  TuningParameters params;
+
+  // The smallest dimension beyond which the Gram assembly is always
+  // faster, compared using a single thread.
+  TuningParameters single_thread(params);
+  single_thread.threads = 1;
+  params.gram_distance_dimension = std::numeric_limits<Eigen::Index>::max();
+  auto dimensions = options.dimensions;
+  std::sort(dimensions.begin(), dimensions.end(), std::greater<>());
+  for (const auto &dimension : dimensions) {
+    const auto xs = details::calibration_features(options.size, dimension);
+    const double gram =
+        details::time_gram_distances(xs, single_thread, options.repeats);
+    const double pairwise =
+        details::time_pairwise_distances(xs, options.repeats);
+    if (gram >= pairwise) {
+      break;
+    }
+    params.gram_distance_dimension = dimension;
+  }
+
+  // Threads and block size are picked jointly using the largest
+  // dimension since that is where the assembly is compute bound.
+  const std::size_t max_threads = tuning_threads(TuningParameters());
+  if (!dimensions.empty() && max_threads > 1) {
+    const auto xs =
+        details::calibration_features(2 * options.size, dimensions.front());
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2) {
+      thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double fastest = std::numeric_limits<double>::max();
+    for (const auto &threads : thread_counts) {
+      for (const auto &block_size : options.block_sizes) {
+        TuningParameters candidate(params);
+        candidate.threads = threads;
+        candidate.parallel_block_size = block_size;
+        const double time =
+            details::time_gram_distances(xs, candidate, options.repeats);
+        if (time < fastest) {
+          fastest = time;
+          params.threads = threads;
+          params.parallel_block_size = block_size;
+        }
+      }
+    }
+    // Let the number of threads follow the hardware when it is best
+    // to use all of it.
+    if (params.threads == max_threads) {
+      params.threads = 0;
+    }
+  }
+  return params;
+}
+
+inline TuningParameters calibrate_tuning_parameters() {
+  return calibrate_tuning_parameters(CalibrationOptions());
+}
+
+/*
+ * The next time the tuning parameters are needed they are read from the
+ * cache file or, if this CPU model isn't in it, calibrated and stored.
+ */
+inline void
+enable_auto_tuning(const std::string &cache_path = default_tuning_cache_path(),
+                   const CalibrationOptions &options = CalibrationOptions()) {
+  enable_auto_tuning(
+      [options]() { return calibrate_tuning_parameters(options); },
+      cache_path);
+}
+
+} // namespace albatross
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_COVARIANCE_FUNCTIONS_COORDINATE_VIEW_H
+#define ALBATROSS_COVARIANCE_FUNCTIONS_COORDINATE_VIEW_H
+
+namespace albatross {
+
+/*
+ * A non-owning view of a single point in a caller owned buffer of
+ * coordinates.  Using these as features avoids copying each point into
+ * its own Eigen::VectorXd (and the allocation that comes with it) when
+ * the coordinates already live in a large contiguous array.
+ *
+ * The caller is responsible for keeping the underlying buffer alive for
+ * as long as any views of it are in use, that includes any fit which
+ * was trained using the views since the fit holds on to its features.
+ */
+struct CoordinateView {
+
+  using MapType = Eigen::Map<const Eigen::VectorXd, Eigen::Unaligned,
+                             Eigen::InnerStride<>>;
+
+  CoordinateView() : data(nullptr), size(0), stride(1){};
+
+  CoordinateView(const double *data_, Eigen::Index size_,
+                 Eigen::Index stride_ = 1)
+      : data(data_), size(size_), stride(stride_){};
+
+  MapType vector() const {
+    return MapType(data, size, Eigen::InnerStride<>(stride));
+  }
+
+  double operator[](Eigen::Index i) const {
+    assert(i >= 0 && i < size);
+    return data[i * stride];
+  }
+
+  bool operator==(const CoordinateView &other) const {
+    if (size != other.size) {
+      return false;
+    }
+    if (data == other.data && stride == other.stride) {
+      return true;
+    }
+    return vector() == other.vector();
+  }
+
+  const double *data;
+  Eigen::Index size;
+  Eigen::Index stride;
+};
+
+/*
+ * Views of n points with `dimension` coordinates each where point i,
+ * coordinate j is located at data[i * point_stride + j * coordinate_stride].
+ */
+inline std::vector<CoordinateView>
+coordinate_views(const double *data, std::size_t n, Eigen::Index dimension,
+                 Eigen::Index point_stride,
+                 Eigen::Index coordinate_stride = 1) {
+  std::vector<CoordinateView> output;
+  output.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    output.emplace_back(data + static_cast<Eigen::Index>(i) * point_stride,
+                        dimension, coordinate_stride);
+  }
+  return output;
+}
+
+/*
+ * Views of each row of a matrix (or Map, or Block of one) regardless of
+ * its storage order.  No coordinates are copied.
+ */
+template <typename Derived>
+inline std::vector<CoordinateView>
+coordinate_views(const Eigen::MatrixBase<Derived> &coordinates) {
+  static_assert(
+      std::is_same<typename Derived::Scalar, double>::value &&
+          static_cast<bool>(Eigen::MatrixBase<Derived>::Flags &
+                            Eigen::DirectAccessBit),
+      "coordinate_views requires direct access to a buffer of doubles");
+  const Derived &x = coordinates.derived();
+  return coordinate_views(x.data(), static_cast<std::size_t>(x.rows()),
+                          x.cols(), x.rowStride(), x.colStride());
+}
+
+inline std::ostream &operator<<(std::ostream &os, const CoordinateView &x) {
+  os << x.vector().transpose();
+  return os;
+}
+
+// Hashes the coordinates (not the address) to be consistent with
+// operator==, which lets fits trained on views cache predictions.
+inline std::size_t hash_value(const CoordinateView &x) {
+  std::size_t seed = static_cast<std::size_t>(x.size);
+  for (Eigen::Index i = 0; i < x.size; ++i) {
+    seed = seed * 31 + std::hash<double>()(x[i]);
+  }
+  return seed;
+}
+
+} // namespace albatross
+
+#endif
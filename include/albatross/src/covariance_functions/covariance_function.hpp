@@ -77,6 +77,54 @@ private:
     return DefaultCaller::call(derived(), x, y);
   }
 
+  /*
+   * By default covariance matrices are assembled one element at a time,
+   * but implementations which can do better (for example by reusing
+   * work shared between elements) can provide:
+   *
+   *   Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const;
+   *
+   *   Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+   *                                const std::vector<Y> &ys) const;
+   *
+   * which must agree with the element-wise definition.
+   */
+  template <typename X,
+            typename std::enable_if<!has_valid_matrix_impl<Derived, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd matrix(const std::vector<X> &xs) const {
+    auto caller = [&](const auto &x, const auto &y) {
+      return this->call(x, y);
+    };
+    return compute_covariance_matrix(caller, xs);
+  }
+
+  template <typename X,
+            typename std::enable_if<has_valid_matrix_impl<Derived, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd matrix(const std::vector<X> &xs) const {
+    return derived()._matrix_impl(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<
+                !has_valid_matrix_impl<Derived, X, Y>::value, int>::type = 0>
+  Eigen::MatrixXd matrix(const std::vector<X> &xs,
+                         const std::vector<Y> &ys) const {
+    auto caller = [&](const auto &x, const auto &y) {
+      return this->call(x, y);
+    };
+    return compute_covariance_matrix(caller, xs, ys);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<has_valid_matrix_impl<Derived, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd matrix(const std::vector<X> &xs,
+                         const std::vector<Y> &ys) const {
+    return derived()._matrix_impl(xs, ys);
+  }
+
 public:
   static_assert(!is_complete<Derived>::value,
                 "\n\nPassing a complete type in as template parameter "
@@ -130,10 +178,7 @@ public:
             typename std::enable_if<has_valid_caller<Derived, X, X>::value,
                                     int>::type = 0>
   Eigen::MatrixXd operator()(const std::vector<X> &xs) const {
-    auto caller = [&](const auto &x, const auto &y) {
-      return this->call(x, y);
-    };
-    return compute_covariance_matrix(caller, xs);
+    return matrix(xs);
   }
 
   /*
@@ -144,10 +189,7 @@ public:
                                     int>::type = 0>
   Eigen::MatrixXd operator()(const std::vector<X> &xs,
                              const std::vector<Y> &ys) const {
-    auto caller = [&](const auto &x, const auto &y) {
-      return this->call(x, y);
-    };
-    return compute_covariance_matrix(caller, xs, ys);
+    return matrix(xs, ys);
   }
 
   /*
@@ -280,6 +322,66 @@ public:
     return this->rhs_(x, y);
   }
 
+  /*
+   * If either LHS or RHS has a specialized way of assembling covariance
+   * matrices the sum is formed from the two matrices so the
+   * specialization gets used.
+   */
+  template <typename X,
+            typename std::enable_if<(has_valid_matrix_impl<LHS, X>::value ||
+                                     has_valid_matrix_impl<RHS, X>::value) &&
+                                        has_valid_caller<LHS, X, X>::value &&
+                                        has_valid_caller<RHS, X, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->lhs_(xs) + this->rhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<(has_valid_matrix_impl<LHS, X, Y>::value ||
+                                     has_valid_matrix_impl<RHS, X, Y>::value) &&
+                                        has_valid_caller<LHS, X, Y>::value &&
+                                        has_valid_caller<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->lhs_(xs, ys) + this->rhs_(xs, ys);
+  }
+
+  template <typename X,
+            typename std::enable_if<has_valid_matrix_impl<LHS, X>::value &&
+                                        !has_valid_caller<RHS, X, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->lhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<has_valid_matrix_impl<LHS, X, Y>::value &&
+                                        !has_valid_caller<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->lhs_(xs, ys);
+  }
+
+  template <typename X,
+            typename std::enable_if<!has_valid_caller<LHS, X, X>::value &&
+                                        has_valid_matrix_impl<RHS, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->rhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<!has_valid_caller<LHS, X, Y>::value &&
+                                        has_valid_matrix_impl<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->rhs_(xs, ys);
+  }
+
   template <typename X,
             typename std::enable_if<has_valid_ssr_impl<LHS, X>::value &&
                                         has_valid_ssr_impl<RHS, X>::value,
@@ -378,6 +480,66 @@ public:
     return this->rhs_(x, y);
   }
 
+  /*
+   * If either LHS or RHS has a specialized way of assembling covariance
+   * matrices the product is formed from the two matrices so the
+   * specialization gets used.
+   */
+  template <typename X,
+            typename std::enable_if<(has_valid_matrix_impl<LHS, X>::value ||
+                                     has_valid_matrix_impl<RHS, X>::value) &&
+                                        has_valid_caller<LHS, X, X>::value &&
+                                        has_valid_caller<RHS, X, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->lhs_(xs).cwiseProduct(this->rhs_(xs));
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<(has_valid_matrix_impl<LHS, X, Y>::value ||
+                                     has_valid_matrix_impl<RHS, X, Y>::value) &&
+                                        has_valid_caller<LHS, X, Y>::value &&
+                                        has_valid_caller<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->lhs_(xs, ys).cwiseProduct(this->rhs_(xs, ys));
+  }
+
+  template <typename X,
+            typename std::enable_if<has_valid_matrix_impl<LHS, X>::value &&
+                                        !has_valid_caller<RHS, X, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->lhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<has_valid_matrix_impl<LHS, X, Y>::value &&
+                                        !has_valid_caller<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->lhs_(xs, ys);
+  }
+
+  template <typename X,
+            typename std::enable_if<!has_valid_caller<LHS, X, X>::value &&
+                                        has_valid_matrix_impl<RHS, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->rhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<!has_valid_caller<LHS, X, Y>::value &&
+                                        has_valid_matrix_impl<RHS, X, Y>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->rhs_(xs, ys);
+  }
+
   template <typename X,
             typename std::enable_if<has_valid_ssr_impl<LHS, X>::value &&
                                         has_valid_ssr_impl<RHS, X>::value,
@@ -42,11 +42,15 @@ public:
                     const Eigen::Matrix<_Scalar, _Rows, 1> &y) const {
     return (x - y).norm();
   }
+
+  double operator()(const CoordinateView &x, const CoordinateView &y) const {
+    return (x.vector() - y.vector()).norm();
+  }
 };
 
-template <typename _Scalar, int _Rows>
-double radial_distance(const Eigen::Matrix<_Scalar, _Rows, 1> &x,
-                       const Eigen::Matrix<_Scalar, _Rows, 1> &y) {
+template <typename DerivedX, typename DerivedY>
+double radial_distance(const Eigen::MatrixBase<DerivedX> &x,
+                       const Eigen::MatrixBase<DerivedY> &y) {
   return fabs(x.norm() - y.norm());
 }
 
@@ -59,11 +63,15 @@ public:
   double operator()(const Eigen::VectorXd &x, const Eigen::VectorXd &y) const {
     return radial_distance(x, y);
   }
+
+  double operator()(const CoordinateView &x, const CoordinateView &y) const {
+    return radial_distance(x.vector(), y.vector());
+  }
 };
 
-template <typename _Scalar, int _Rows>
-double angular_distance(const Eigen::Matrix<_Scalar, _Rows, 1> &x,
-                        const Eigen::Matrix<_Scalar, _Rows, 1> &y) {
+template <typename DerivedX, typename DerivedY>
+double angular_distance(const Eigen::MatrixBase<DerivedX> &x,
+                        const Eigen::MatrixBase<DerivedY> &y) {
   // The acos operator doesn't behave well near |1|.  acos(1.), for example,
   // returns NaN, so here we do some special casing,
   double dot_product = x.dot(y) / (x.norm() * y.norm());
@@ -87,6 +95,10 @@ public:
                     const Eigen::Matrix<_Scalar, _Rows, 1> &y) const {
     return angular_distance(x, y);
   }
+
+  double operator()(const CoordinateView &x, const CoordinateView &y) const {
+    return angular_distance(x.vector(), y.vector());
+  }
 };
 
 template <typename Feature, typename DistanceMetrixType>
@@ -108,6 +120,218 @@ Eigen::MatrixXd distance_matrix(const DistanceMetrixType &distance_metric,
   return D;
 }
 
+/*
+ * Euclidean distances between features with many coordinates can be
+ * computed from inner products, |x - y|^2 = |x|^2 + |y|^2 - 2 x^T y, which
+ * turns the bulk of the work into a cache blocked matrix product instead
+ * of a memory bound loop over pairs.  For features with fewer coordinates
+ * than TuningParameters::gram_distance_dimension the pairwise loop is
+ * faster.
+ *
+ * Gram distances are only used for the Euclidean distance between
+ * features with the coordinates stored as doubles.
+ */
+namespace details {
+
+template <typename X> struct is_coordinate_vector : public std::false_type {};
+
+template <int _Rows>
+struct is_coordinate_vector<Eigen::Matrix<double, _Rows, 1>>
+    : public std::true_type {};
+
+template <>
+struct is_coordinate_vector<CoordinateView> : public std::true_type {};
+
+template <int _Rows>
+inline const Eigen::Matrix<double, _Rows, 1> &
+coordinates(const Eigen::Matrix<double, _Rows, 1> &x) {
+  return x;
+}
+
+inline CoordinateView::MapType coordinates(const CoordinateView &x) {
+  return x.vector();
+}
+
+} // namespace details
+
+template <typename DistanceMetricType, typename X>
+struct can_use_gram_distances
+    : public std::integral_constant<
+          bool, std::is_same<DistanceMetricType, EuclideanDistance>::value &&
+                    details::is_coordinate_vector<X>::value> {};
+
+namespace details {
+
+/*
+ * The number of coordinates shared by all the features, or -1 if
+ * they differ.
+ */
+template <typename X>
+inline Eigen::Index common_dimension(const std::vector<X> &xs) {
+  if (xs.empty()) {
+    return -1;
+  }
+  const Eigen::Index dimension = coordinates(xs[0]).size();
+  for (const auto &x : xs) {
+    if (coordinates(x).size() != dimension) {
+      return -1;
+    }
+  }
+  return dimension;
+}
+
+template <typename X>
+inline Eigen::VectorXd coordinate_sum(const std::vector<X> &xs,
+                                      Eigen::Index dimension) {
+  Eigen::VectorXd sum = Eigen::VectorXd::Zero(dimension);
+  for (const auto &x : xs) {
+    sum += coordinates(x);
+  }
+  return sum;
+}
+
+/*
+ * Packs each feature, shifted by `center`, into a column of a matrix.
+ * Centering keeps the norms small which limits the cancellation in
+ * |x|^2 + |y|^2 - 2 x^T y for nearby points far from the origin.
+ */
+template <typename X>
+inline Eigen::MatrixXd pack_coordinates(const std::vector<X> &xs,
+                                        const Eigen::VectorXd &center) {
+  Eigen::MatrixXd packed(center.size(), static_cast<Eigen::Index>(xs.size()));
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    packed.col(static_cast<Eigen::Index>(i)) = coordinates(xs[i]) - center;
+  }
+  return packed;
+}
+
+/*
+ * The rounding error in a squared distance computed from the Gram matrix
+ * is proportional to |x|^2 + |y|^2, pairs for which the squared distance
+ * is smaller than this fraction of that are recomputed directly.
+ */
+constexpr double gram_distance_refine_ratio = 1e-4;
+
+template <typename TransformFunction>
+inline Eigen::MatrixXd
+transformed_gram_distances(const Eigen::MatrixXd &xs, const Eigen::MatrixXd &ys,
+                           bool symmetric, const TransformFunction &transform,
+                           const TuningParameters &params) {
+  assert(xs.rows() == ys.rows());
+  const Eigen::Index m = xs.cols();
+  const Eigen::Index n = ys.cols();
+  Eigen::MatrixXd output = allocate_large_matrix(m, n);
+  if (m == 0 || n == 0) {
+    return output;
+  }
+
+  const Eigen::VectorXd x_norms = xs.colwise().squaredNorm().transpose();
+  const Eigen::VectorXd y_norms = ys.colwise().squaredNorm().transpose();
+
+  // For symmetric outputs only the lower triangle is computed.
+  auto fill_block = [&](const std::pair<Eigen::Index, Eigen::Index> &block) {
+    const Eigen::Index first = block.first;
+    const Eigen::Index cols = block.second;
+    const Eigen::Index row_begin = symmetric ? first : 0;
+    const Eigen::Index rows = m - row_begin;
+    auto out = output.block(row_begin, first, rows, cols);
+    if (symmetric) {
+      // The diagonal block only needs its lower triangle.
+      auto diagonal_block = out.topRows(cols);
+      diagonal_block.setZero();
+      diagonal_block.template selfadjointView<Eigen::Lower>().rankUpdate(
+          xs.middleCols(first, cols).transpose());
+      out.bottomRows(rows - cols).noalias() =
+          xs.middleCols(first + cols, rows - cols).transpose() *
+          ys.middleCols(first, cols);
+    } else {
+      out.noalias() = xs.middleCols(row_begin, rows).transpose() *
+                      ys.middleCols(first, cols);
+    }
+    for (Eigen::Index j = 0; j < cols; ++j) {
+      const Eigen::Index col = first + j;
+      for (Eigen::Index i = 0; i < rows; ++i) {
+        const Eigen::Index row = row_begin + i;
+        if (symmetric && row <= col) {
+          out(i, j) = row == col ? transform(0.) : 0.;
+          continue;
+        }
+        const double norms = x_norms[row] + y_norms[col];
+        double squared = norms - 2. * out(i, j);
+        if (squared < gram_distance_refine_ratio * norms) {
+          // Mostly cancellation, the Gram formulation loses too much
+          // precision for points this close together.
+          squared = (xs.col(row) - ys.col(col)).squaredNorm();
+        }
+        out(i, j) = transform(std::sqrt(squared));
+      }
+    }
+  };
+
+  auto mirror_block = [&](const std::pair<Eigen::Index, Eigen::Index> &block) {
+    for (Eigen::Index col = block.first; col < block.first + block.second;
+         ++col) {
+      for (Eigen::Index row = 0; row < col; ++row) {
+        output(row, col) = output(col, row);
+      }
+    }
+  };
+
+  // Each column block of the output is a separate matrix product which
+  // is handed to the next free worker.
+  auto blocks = tuned_column_blocks(m, n, params, symmetric);
+
+  const std::size_t threads = tuning_threads(params);
+  bounded_async_apply(blocks, fill_block, threads);
+  if (symmetric) {
+    // Mirroring is the other way around, the last columns have the most
+    // to copy so they're started first.
+    std::reverse(blocks.begin(), blocks.end());
+    bounded_async_apply(blocks, mirror_block, threads);
+  }
+  return output;
+}
+
+} // namespace details
+
+/*
+ * Computes transform(|x - y|) for all pairs of features using the Gram
+ * formulation, where transform is typically the profile of a radial
+ * covariance function which is then applied in place.
+ */
+template <typename X, typename TransformFunction,
+          typename std::enable_if<details::is_coordinate_vector<X>::value,
+                                  int>::type = 0>
+inline Eigen::MatrixXd
+gram_euclidean_distances(const std::vector<X> &xs,
+                         const TransformFunction &transform) {
+  const Eigen::Index dimension = details::common_dimension(xs);
+  assert(dimension >= 0 && "features must share a dimension");
+  const Eigen::VectorXd center = details::coordinate_sum(xs, dimension) /
+                                 static_cast<double>(xs.size());
+  const Eigen::MatrixXd packed = details::pack_coordinates(xs, center);
+  return details::transformed_gram_distances(packed, packed, true, transform,
+                                             get_tuning_parameters());
+}
+
+template <typename X, typename TransformFunction,
+          typename std::enable_if<details::is_coordinate_vector<X>::value,
+                                  int>::type = 0>
+inline Eigen::MatrixXd
+gram_euclidean_distances(const std::vector<X> &xs, const std::vector<X> &ys,
+                         const TransformFunction &transform) {
+  const Eigen::Index dimension = details::common_dimension(xs);
+  assert(dimension >= 0 && dimension == details::common_dimension(ys) &&
+         "features must share a dimension");
+  const Eigen::VectorXd center = (details::coordinate_sum(xs, dimension) +
+                                  details::coordinate_sum(ys, dimension)) /
+                                 static_cast<double>(xs.size() + ys.size());
+  return details::transformed_gram_distances(
+      details::pack_coordinates(xs, center),
+      details::pack_coordinates(ys, center), false, transform,
+      get_tuning_parameters());
+}
+
 } // namespace albatross
 
 #endif
@@ -18,6 +18,40 @@ constexpr double default_radial_sigma = 10.;
 
 namespace albatross {
 
+/*
+ * Radial covariance matrices using the Euclidean distance between features
+ * with at least TuningParameters::gram_distance_dimension coordinates are
+ * assembled from the Gram matrix of the features, smaller ones fall back
+ * to evaluating the profile of each pairwise distance.
+ */
+template <typename X, typename ProfileFunction>
+inline Eigen::MatrixXd
+euclidean_radial_covariance(const std::vector<X> &xs,
+                            const ProfileFunction &profile) {
+  const Eigen::Index min_dimension =
+      get_tuning_parameters().gram_distance_dimension;
+  if (details::common_dimension(xs) >= min_dimension) {
+    return gram_euclidean_distances(xs, profile);
+  }
+  const EuclideanDistance distance;
+  auto caller = [&](const X &x, const X &y) { return profile(distance(x, y)); };
+  return compute_covariance_matrix(caller, xs);
+}
+
+template <typename X, typename ProfileFunction>
+inline Eigen::MatrixXd
+euclidean_radial_covariance(const std::vector<X> &xs, const std::vector<X> &ys,
+                            const ProfileFunction &profile) {
+  const Eigen::Index dimension = details::common_dimension(xs);
+  if (dimension >= get_tuning_parameters().gram_distance_dimension &&
+      dimension == details::common_dimension(ys)) {
+    return gram_euclidean_distances(xs, ys, profile);
+  }
+  const EuclideanDistance distance;
+  auto caller = [&](const X &x, const X &y) { return profile(distance(x, y)); };
+  return compute_covariance_matrix(caller, xs, ys);
+}
+
 inline double squared_exponential_covariance(double distance,
                                              double length_scale,
                                              double sigma = 1.) {
@@ -71,16 +105,46 @@ public:
     return linspace(min, max, safe_cast_to_size_t(n));
   }
 
+  /*
+   * The covariance as a function of distance, along with the distance
+   * over which it decays, are used by the TabulatedRadial wrapper.
+   */
+  double profile(double distance) const {
+    return squared_exponential_covariance(
+        distance, squared_exponential_length_scale.value,
+        sigma_squared_exponential.value);
+  }
+
+  double length_scale() const {
+    return squared_exponential_length_scale.value;
+  }
+
   // This operator is only defined when the distance metric is also defined.
   template <typename X,
             typename std::enable_if<
                 has_call_operator<DistanceMetricType, X &, X &>::value,
                 int>::type = 0>
   double _call_impl(const X &x, const X &y) const {
-    double distance = this->distance_metric_(x, y);
-    return squared_exponential_covariance(
-        distance, squared_exponential_length_scale.value,
-        sigma_squared_exponential.value);
+    return profile(this->distance_metric_(x, y));
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return euclidean_radial_covariance(
+        xs, [this](double d) { return this->profile(d); });
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<X> &ys) const {
+    return euclidean_radial_covariance(
+        xs, ys, [this](double d) { return this->profile(d); });
   }
 
   DistanceMetricType distance_metric_;
@@ -129,15 +193,39 @@ public:
     return linspace(min, max, safe_cast_to_size_t(n));
   }
 
+  double profile(double distance) const {
+    return exponential_covariance(distance, exponential_length_scale.value,
+                                  sigma_exponential.value);
+  }
+
+  double length_scale() const { return exponential_length_scale.value; }
+
   // This operator is only defined when the distance metric is also defined.
   template <typename X,
             typename std::enable_if<
                 has_call_operator<DistanceMetricType, X &, X &>::value,
                 int>::type = 0>
   double _call_impl(const X &x, const X &y) const {
-    double distance = this->distance_metric_(x, y);
-    return exponential_covariance(distance, exponential_length_scale.value,
-                                  sigma_exponential.value);
+    return profile(this->distance_metric_(x, y));
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return euclidean_radial_covariance(
+        xs, [this](double d) { return this->profile(d); });
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<X> &ys) const {
+    return euclidean_radial_covariance(
+        xs, ys, [this](double d) { return this->profile(d); });
   }
 
   DistanceMetricType distance_metric_;
@@ -116,10 +116,64 @@ public:
     return this->scaling_function_._call_impl(x);
   }
 
+  /*
+   * Evaluates the scaling function once for each feature, features which
+   * the scaling function doesn't apply to are left unscaled.
+   */
+  template <typename X, typename std::enable_if<
+                            has_valid_call_impl<ScalingFunction, X &>::value,
+                            int>::type = 0>
+  Eigen::VectorXd scaling_vector(const std::vector<X> &xs) const {
+    auto caller = [&](const auto &x) {
+      return this->scaling_function_._call_impl(x);
+    };
+    return compute_mean_vector(caller, xs);
+  }
+
+  template <typename X, typename std::enable_if<
+                            !has_valid_call_impl<ScalingFunction, X &>::value,
+                            int>::type = 0>
+  Eigen::VectorXd scaling_vector(const std::vector<X> &xs) const {
+    return Eigen::VectorXd::Ones(static_cast<Eigen::Index>(xs.size()));
+  }
+
 private:
   ScalingFunction scaling_function_;
 };
 
+/*
+ * Covariance functions of the form f(x) * cov(x, y) * f(y) can be
+ * assembled as diag(f(xs)) * cov(xs, ys) * diag(f(ys)) which only
+ * requires the scaling function be evaluated once per feature instead
+ * of twice per element.  This is only used when the scaling function
+ * is defined directly for one of the feature types, other types (such
+ * as variants or measurements) go through the element-wise path.
+ */
+template <typename ScalingFunction, typename X, typename Y = X>
+struct can_assemble_scaled_matrix {
+  static constexpr bool value =
+      has_valid_call_impl<ScalingFunction, X &>::value ||
+      has_valid_call_impl<ScalingFunction, Y &>::value;
+};
+
+template <typename ScalingFunction, typename CovFunc, typename X, typename Y>
+inline Eigen::MatrixXd
+scaled_covariance_matrix(const ScalingTerm<ScalingFunction> &scaling,
+                         const CovFunc &cov_func, const std::vector<X> &xs,
+                         const std::vector<Y> &ys) {
+  const Eigen::VectorXd x_scale = scaling.scaling_vector(xs);
+  const Eigen::VectorXd y_scale = scaling.scaling_vector(ys);
+  return x_scale.asDiagonal() * cov_func(xs, ys) * y_scale.asDiagonal();
+}
+
+template <typename ScalingFunction, typename CovFunc, typename X>
+inline Eigen::MatrixXd
+scaled_covariance_matrix(const ScalingTerm<ScalingFunction> &scaling,
+                         const CovFunc &cov_func, const std::vector<X> &xs) {
+  const Eigen::VectorXd scale = scaling.scaling_vector(xs);
+  return scale.asDiagonal() * cov_func(xs) * scale.asDiagonal();
+}
+
 /*
  * Product in the form:  scaling_term * other
  */
@@ -179,6 +233,46 @@ public:
     return this->rhs_(x, y);
   }
 
+  /*
+   * Assembles covariance matrices by scaling the RHS matrix.
+   */
+  template <typename X,
+            typename std::enable_if<
+                can_assemble_scaled_matrix<ScalingFunction, X>::value &&
+                    has_valid_caller<RHS, X, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return scaled_covariance_matrix(this->lhs_, this->rhs_, xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<
+                can_assemble_scaled_matrix<ScalingFunction, X, Y>::value &&
+                    has_valid_caller<RHS, X, Y>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return scaled_covariance_matrix(this->lhs_, this->rhs_, xs, ys);
+  }
+
+  template <typename X,
+            typename std::enable_if<!has_valid_caller<LHS, X, X>::value &&
+                                        has_valid_matrix_impl<RHS, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->rhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<
+                !has_valid_caller<LHS, X, Y>::value &&
+                    has_valid_matrix_impl<RHS, X, Y>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->rhs_(xs, ys);
+  }
+
 protected:
   LHS lhs_;
   RHS rhs_;
@@ -244,6 +338,46 @@ public:
     return this->lhs_(x, y);
   }
 
+  /*
+   * Assembles covariance matrices by scaling the LHS matrix.
+   */
+  template <typename X,
+            typename std::enable_if<
+                can_assemble_scaled_matrix<ScalingFunction, X>::value &&
+                    has_valid_caller<LHS, X, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return scaled_covariance_matrix(this->rhs_, this->lhs_, xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<
+                can_assemble_scaled_matrix<ScalingFunction, X, Y>::value &&
+                    has_valid_caller<LHS, X, Y>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return scaled_covariance_matrix(this->rhs_, this->lhs_, xs, ys);
+  }
+
+  template <typename X,
+            typename std::enable_if<!has_valid_caller<RHS, X, X>::value &&
+                                        has_valid_matrix_impl<LHS, X>::value,
+                                    int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return this->lhs_(xs);
+  }
+
+  template <typename X, typename Y,
+            typename std::enable_if<
+                !has_valid_caller<RHS, X, Y>::value &&
+                    has_valid_matrix_impl<LHS, X, Y>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<Y> &ys) const {
+    return this->lhs_(xs, ys);
+  }
+
 protected:
   LHS lhs_;
   RHS rhs_;
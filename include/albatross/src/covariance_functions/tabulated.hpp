@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2019 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_COVARIANCE_FUNCTIONS_TABULATED_H
+#define ALBATROSS_COVARIANCE_FUNCTIONS_TABULATED_H
+
+/*
+ * Evaluating a radial covariance function is typically dominated by the
+ * call to exp, pow or some special function.  TabulatedRadial wraps a
+ * radial covariance function and replaces that evaluation with a cubic
+ * interpolation of values precomputed on a uniform grid of distances.
+ *
+ * The grid is refined until the interpolation error is below
+ * `tolerance` times the variance (the profile at zero distance) and
+ * extends out to the distance at which the profile itself drops below
+ * that threshold, beyond which the covariance is treated as zero.
+ *
+ * The wrapped covariance function needs to provide:
+ *
+ *   double profile(double distance) const;
+ *   double length_scale() const;
+ *
+ * along with a public `distance_metric_`, which is the case for the
+ * covariance functions in radial.hpp.  The table is rebuilt any time a
+ * parameter is modified.
+ */
+
+namespace albatross {
+
+constexpr double default_tabulated_tolerance = 1e-10;
+
+namespace details {
+
+/*
+ * Limits the size of the table in case the tolerance can't be reached,
+ * for example if the profile is not smooth.
+ */
+constexpr std::size_t max_tabulated_size = 1 << 22;
+
+/*
+ * Cubic interpolation on a uniform grid with unit spacing.  The four
+ * nodes used are centered on the interval containing `s` where possible
+ * and shifted inwards at the ends of the table.
+ */
+inline double interpolate_uniform_cubic(const std::vector<double> &values,
+                                        double s) {
+  const std::size_t n = values.size();
+  assert(n >= 4);
+  std::size_t first = static_cast<std::size_t>(s);
+  first = first > 0 ? first - 1 : 0;
+  first = std::min(first, n - 4);
+  const double u = s - static_cast<double>(first);
+  const double *v = values.data() + first;
+  return -v[0] * (u - 1.) * (u - 2.) * (u - 3.) / 6. +
+         v[1] * u * (u - 2.) * (u - 3.) / 2. -
+         v[2] * u * (u - 1.) * (u - 3.) / 2. +
+         v[3] * u * (u - 1.) * (u - 2.) / 6.;
+}
+
+} // namespace details
+
+template <typename SubCovariance>
+class TabulatedRadial
+    : public CovarianceFunction<TabulatedRadial<SubCovariance>> {
+
+  using DistanceMetricType = typename std::decay<decltype(
+      std::declval<SubCovariance>().distance_metric_)>::type;
+
+public:
+  TabulatedRadial(const SubCovariance &sub_cov = SubCovariance(),
+                  double tolerance = default_tabulated_tolerance)
+      : sub_cov_(sub_cov), tolerance_(tolerance), max_distance_(0.),
+        inverse_spacing_(0.), values_() {
+    assert(tolerance_ > 0.);
+    build_table();
+  };
+
+  std::string name() const {
+    return "tabulated[" + sub_cov_.get_name() + "]";
+  }
+
+  ParameterStore get_params() const override { return sub_cov_.get_params(); }
+
+  void unchecked_set_param(const ParameterKey &name,
+                           const Parameter &param) override {
+    sub_cov_.set_param(name, param);
+    build_table();
+  }
+
+  double profile(double distance) const {
+    assert(distance >= 0.);
+    if (distance >= max_distance_) {
+      return 0.;
+    }
+    return details::interpolate_uniform_cubic(values_,
+                                              distance * inverse_spacing_);
+  }
+
+  double length_scale() const { return sub_cov_.length_scale(); }
+
+  std::size_t table_size() const { return values_.size(); }
+
+  template <typename X,
+            typename std::enable_if<
+                has_call_operator<DistanceMetricType, X &, X &>::value,
+                int>::type = 0>
+  double _call_impl(const X &x, const X &y) const {
+    return profile(sub_cov_.distance_metric_(x, y));
+  }
+
+  /*
+   * Matrices are assembled by first computing all the distances then
+   * looking each of them up in the table.
+   */
+  template <typename X,
+            typename std::enable_if<
+                has_call_operator<DistanceMetricType, X &, X &>::value &&
+                    !can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    const auto distances =
+        compute_covariance_matrix(sub_cov_.distance_metric_, xs);
+    return distances.unaryExpr([this](double d) { return profile(d); });
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                has_call_operator<DistanceMetricType, X &, X &>::value &&
+                    !can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<X> &ys) const {
+    const auto distances =
+        compute_covariance_matrix(sub_cov_.distance_metric_, xs, ys);
+    return distances.unaryExpr([this](double d) { return profile(d); });
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs) const {
+    return euclidean_radial_covariance(
+        xs, [this](double d) { return this->profile(d); });
+  }
+
+  template <typename X,
+            typename std::enable_if<
+                can_use_gram_distances<DistanceMetricType, X>::value,
+                int>::type = 0>
+  Eigen::MatrixXd _matrix_impl(const std::vector<X> &xs,
+                               const std::vector<X> &ys) const {
+    return euclidean_radial_covariance(
+        xs, ys, [this](double d) { return this->profile(d); });
+  }
+
+private:
+  void build_table() {
+    values_.clear();
+    max_distance_ = 0.;
+    inverse_spacing_ = 0.;
+
+    const double variance = fabs(sub_cov_.profile(0.));
+    const double length_scale = sub_cov_.length_scale();
+    if (variance == 0. || length_scale <= 0.) {
+      return;
+    }
+    const double threshold = tolerance_ * variance;
+
+    // Find the distance beyond which the covariance is negligible.
+    max_distance_ = length_scale;
+    while (fabs(sub_cov_.profile(max_distance_)) > threshold &&
+           max_distance_ < 1e6 * length_scale) {
+      max_distance_ *= 2.;
+    }
+
+    std::size_t intervals = 64;
+    while (true) {
+      const double spacing = max_distance_ / static_cast<double>(intervals);
+      values_.resize(intervals + 1);
+      for (std::size_t i = 0; i <= intervals; ++i) {
+        values_[i] = sub_cov_.profile(static_cast<double>(i) * spacing);
+      }
+      inverse_spacing_ = 1. / spacing;
+
+      if (intervals >= details::max_tabulated_size ||
+          max_interpolation_error(spacing) <= threshold) {
+        break;
+      }
+      intervals *= 2;
+    }
+  }
+
+  // The interpolation error vanishes at the nodes so is checked at a
+  // few points within each interval.
+  double max_interpolation_error(double spacing) const {
+    double max_error = 0.;
+    for (std::size_t i = 0; i + 1 < values_.size(); ++i) {
+      for (const double offset : {0.25, 0.5, 0.75}) {
+        const double s = static_cast<double>(i) + offset;
+        const double error =
+            fabs(details::interpolate_uniform_cubic(values_, s) -
+                 sub_cov_.profile(s * spacing));
+        max_error = std::max(max_error, error);
+      }
+    }
+    return max_error;
+  }
+
+  SubCovariance sub_cov_;
+  double tolerance_;
+  double max_distance_;
+  double inverse_spacing_;
+  std::vector<double> values_;
+};
+
+/*
+ * Utility function to act as a constructor but with template param resolution.
+ */
+template <typename SubCovariance>
+TabulatedRadial<SubCovariance>
+tabulated(const SubCovariance &cov,
+          double tolerance = default_tabulated_tolerance) {
+  return TabulatedRadial<SubCovariance>(cov, tolerance);
+}
+
+} // namespace albatross
+
+#endif
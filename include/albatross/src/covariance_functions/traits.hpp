@@ -83,6 +83,26 @@ public:
                                  !has_valid_call_impl<T, Args...>::value);
 };
 
+DEFINE_CLASS_METHOD_TRAITS(_matrix_impl);
+
+/*
+ * Checks if a covariance function provides a specialized way of
+ * assembling the covariance matrix for vectors of features,
+ *
+ *   has_valid_matrix_impl<CovFunc, X>::value
+ *
+ * for `_matrix_impl(const std::vector<X> &)` and
+ *
+ *   has_valid_matrix_impl<CovFunc, X, Y>::value
+ *
+ * for `_matrix_impl(const std::vector<X> &, const std::vector<Y> &)`.
+ */
+template <typename U, typename... Features>
+class has_valid_matrix_impl
+    : public has__matrix_impl_with_return_type<
+          const U, Eigen::MatrixXd,
+          typename const_ref<std::vector<Features>>::type...> {};
+
 DEFINE_CLASS_METHOD_TRAITS(solve);
 
 DEFINE_CLASS_METHOD_TRAITS(_ssr_impl);
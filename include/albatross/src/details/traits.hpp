@@ -141,6 +141,46 @@ struct variant_all<Expression, variant<A, Ts...>,
       Expression<A>::value && variant_all<Expression, variant<Ts...>>::value;
 };
 
+/*
+ * is_equality_comparable
+ */
+
+template <typename T> class is_equality_comparable {
+  template <typename C>
+  static auto test(int) -> decltype(std::declval<const C &>() ==
+                                        std::declval<const C &>(),
+                                    std::true_type());
+
+  template <typename> static std::false_type test(...);
+
+public:
+  static const bool value = decltype(test<T>(0))::value;
+};
+
+// A variant always declares operator== but it can only be used if all
+// of the types it holds can be compared.
+template <typename... Ts>
+class is_equality_comparable<variant<Ts...>>
+    : public variant_all<is_equality_comparable, variant<Ts...>> {};
+
+/*
+ * has_hash_value, a customization point for hashing features which is
+ * found by argument dependent lookup:
+ *
+ *   std::size_t hash_value(const MyFeature &x);
+ */
+template <typename T> class has_hash_value {
+  template <typename C>
+  static auto test(int) -> decltype(
+      static_cast<std::size_t>(hash_value(std::declval<const C &>())),
+      std::true_type());
+
+  template <typename> static std::false_type test(...);
+
+public:
+  static const bool value = decltype(test<T>(0))::value;
+};
+
 /*
  * Checks if one variant contains all the types of another variant.
  */
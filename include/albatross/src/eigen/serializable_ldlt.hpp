@@ -20,7 +20,9 @@ class SerializableLDLT : public LDLT<MatrixXd, Lower> {
 public:
   SerializableLDLT() : LDLT<MatrixXd, Lower>(){};
 
-  SerializableLDLT(const MatrixXd &x) : LDLT<MatrixXd, Lower>(x.ldlt()){};
+  // Factorizes directly into the decomposition's own buffer instead of
+  // copying an intermediate LDLT.
+  SerializableLDLT(const MatrixXd &x) : LDLT<MatrixXd, Lower>(x){};
 
   SerializableLDLT(const LDLT<MatrixXd, Lower> &ldlt)
       // Can we get around copying here?
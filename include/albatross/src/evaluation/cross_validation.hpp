@@ -324,6 +324,117 @@ public:
     const auto indexer = group_by(dataset, index_function).indexers();
     return scores(metric, dataset, indexer);
   }
+
+  // Covariance Reusing Predictions
+  //
+  // For Gaussian process backed models (anything with `compute_covariance`
+  // and `get_mean` methods) which don't provide a specialized
+  // `cross_validated_predictions`.  Instead of refitting each fold from
+  // scratch the covariance between all features is computed once and
+  // each fold's train, cross and test blocks are sliced out of it.
+  // Gaussian processes wrapped in Ransac using a
+  // GaussianProcessRansacStrategy are supported as well, in which case
+  // each fold's RANSAC is also run on slices of that covariance.
+
+  template <typename PredictType, typename FeatureType, typename GroupKey>
+  Grouped<GroupKey, PredictType> predictions_reusing_covariance(
+      const RegressionDataset<FeatureType> &dataset,
+      const GroupIndexer<GroupKey> &indexer,
+      PredictTypeIdentity<PredictType> = PredictTypeIdentity<PredictType>())
+      const {
+    return Grouped<GroupKey, PredictType>(
+        gp_cross_validated_predictions_reusing_covariance(
+            dataset, indexer, model_, PredictTypeIdentity<PredictType>()));
+  }
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename GroupKey>
+  Eigen::VectorXd
+  scores_reusing_covariance(const PredictionMetric<RequiredPredictType> &metric,
+                            const RegressionDataset<FeatureType> &dataset,
+                            const GroupIndexer<GroupKey> &indexer) const {
+    const auto folds = folds_from_group_indexer(dataset, indexer);
+    const auto predictions =
+        predictions_reusing_covariance<RequiredPredictType>(dataset, indexer);
+    return cross_validated_scores(metric, folds, predictions);
+  }
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename IndexFunc>
+  Eigen::VectorXd
+  scores_reusing_covariance(const PredictionMetric<RequiredPredictType> &metric,
+                            const RegressionDataset<FeatureType> &dataset,
+                            const IndexFunc &index_function) const {
+    const auto indexer = group_by(dataset, index_function).indexers();
+    return scores_reusing_covariance(metric, dataset, indexer);
+  }
+
+  // Streaming Scores
+  //
+  // Fits and predicts one fold at a time, hands the resulting score to
+  // `reducer` and discards the prediction before moving on to the next
+  // fold.  This keeps memory flat regardless of the number of folds, at
+  // the cost of skipping any model specific cross validation shortcuts.
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename GroupKey, typename ScoreReducer>
+  ScoreReducer
+  streaming_scores(const PredictionMetric<RequiredPredictType> &metric,
+                   const RegressionDataset<FeatureType> &dataset,
+                   const GroupIndexer<GroupKey> &indexer,
+                   ScoreReducer reducer) const {
+    for (const auto &pair : indexer) {
+      const auto fold = create_fold(pair.second, dataset);
+      const double score =
+          metric(predict_fold(model_, fold), fold.test_dataset.targets);
+      reducer(pair.first, score);
+    }
+    return reducer;
+  }
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename IndexFunc, typename ScoreReducer>
+  ScoreReducer
+  streaming_scores(const PredictionMetric<RequiredPredictType> &metric,
+                   const RegressionDataset<FeatureType> &dataset,
+                   const IndexFunc &index_function,
+                   ScoreReducer reducer) const {
+    const auto indexer = group_by(dataset, index_function).indexers();
+    return streaming_scores(metric, dataset, indexer, std::move(reducer));
+  }
+
+  // Process Scores
+  //
+  // Fits, predicts and scores each fold in a separate worker process,
+  // see process_apply, which requires including albatross/utils/ProcessUtils.
+  // Only the scores are sent back, so the coordinating process never
+  // holds more than one fold's worth of data.
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename GroupKey>
+  Eigen::VectorXd
+  process_scores(const PredictionMetric<RequiredPredictType> &metric,
+                 const RegressionDataset<FeatureType> &dataset,
+                 const GroupIndexer<GroupKey> &indexer,
+                 std::size_t max_processes = 0) const {
+    const auto score_one_fold = [&](const GroupKey &,
+                                    const GroupIndices &test_indices) {
+      const auto fold = create_fold(test_indices, dataset);
+      return metric(predict_fold(model_, fold), fold.test_dataset.targets);
+    };
+    return combine(process_apply(indexer, score_one_fold, max_processes));
+  }
+
+  template <typename RequiredPredictType, typename FeatureType,
+            typename IndexFunc>
+  Eigen::VectorXd
+  process_scores(const PredictionMetric<RequiredPredictType> &metric,
+                 const RegressionDataset<FeatureType> &dataset,
+                 const IndexFunc &index_function,
+                 std::size_t max_processes = 0) const {
+    const auto indexer = group_by(dataset, index_function).indexers();
+    return process_scores(metric, dataset, indexer, max_processes);
+  }
 };
 
 template <typename ModelType>
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_EVALUATION_SCORE_REDUCERS_H_
+#define ALBATROSS_EVALUATION_SCORE_REDUCERS_H_
+
+/*
+ * A ScoreReducer accumulates the metric computed for each cross validation
+ * fold as soon as it is available, which lets the fold's prediction be
+ * discarded immediately.  Any type with a method,
+ *
+ *   void operator()(const GroupKey &key, double score);
+ *
+ * can be used, the reducers below cover the common cases.
+ */
+
+namespace albatross {
+
+/*
+ * Keeps running statistics of the scores using Welford's algorithm.
+ */
+struct RunningStatsReducer {
+
+  RunningStatsReducer() : count(0), sum(0.), mean_(0.), m2_(0.){};
+
+  template <typename GroupKey>
+  void operator()(const GroupKey &, double score) {
+    ++count;
+    sum += score;
+    const double delta = score - mean_;
+    mean_ += delta / static_cast<double>(count);
+    m2_ += delta * (score - mean_);
+  }
+
+  double mean() const { return count > 0 ? mean_ : NAN; }
+
+  double variance() const {
+    return count > 1 ? m2_ / static_cast<double>(count - 1) : NAN;
+  }
+
+  std::size_t count;
+  double sum;
+
+private:
+  double mean_;
+  double m2_;
+};
+
+/*
+ * Counts the scores falling between consecutive bin edges, scores outside
+ * the edges are tracked separately.
+ */
+struct HistogramReducer {
+
+  HistogramReducer(const std::vector<double> &edges_)
+      : edges(edges_), counts(edges_.size() > 0 ? edges_.size() - 1 : 0, 0),
+        below(0), above(0) {
+    assert(std::is_sorted(edges.begin(), edges.end()));
+  };
+
+  template <typename GroupKey> void operator()(const GroupKey &, double score) {
+    if (edges.empty() || score < edges.front()) {
+      ++below;
+    } else if (score >= edges.back()) {
+      ++above;
+    } else {
+      const auto upper = std::upper_bound(edges.begin(), edges.end(), score);
+      ++counts[static_cast<std::size_t>(
+          std::distance(edges.begin(), upper) - 1)];
+    }
+  }
+
+  std::vector<double> edges;
+  std::vector<std::size_t> counts;
+  std::size_t below;
+  std::size_t above;
+};
+
+/*
+ * Applies several reducers to the same stream of scores.
+ */
+template <typename... Reducers> struct CombinedReducer {
+
+  CombinedReducer(const Reducers &... reducers_) : reducers(reducers_...){};
+
+  template <typename GroupKey>
+  void operator()(const GroupKey &key, double score) {
+    apply_each(key, score, std::index_sequence_for<Reducers...>());
+  }
+
+  std::tuple<Reducers...> reducers;
+
+private:
+  template <typename GroupKey, std::size_t... Is>
+  void apply_each(const GroupKey &key, double score,
+                  std::index_sequence<Is...>) {
+    // Expands to calling each reducer in order.
+    (void)std::initializer_list<int>{
+        (std::get<Is>(reducers)(key, score), 0)...};
+  }
+};
+
+template <typename... Reducers>
+inline auto combine_reducers(const Reducers &... reducers) {
+  return CombinedReducer<Reducers...>(reducers...);
+}
+
+} // namespace albatross
+
+#endif /* ALBATROSS_EVALUATION_SCORE_REDUCERS_H_ */
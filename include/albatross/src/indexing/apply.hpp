@@ -109,11 +109,85 @@ inline void apply_map(const Map<KeyType, ValueType> &map, ApplyFunction &&f) {
   }
 }
 
+// Consuming Map
+//
+// These take ownership of the map and move each value into the apply
+// function, erasing it as soon as it's been processed so the input and
+// output don't need to coexist in memory.
+
+template <
+    typename KeyType, typename ValueType, typename ApplyFunction,
+    typename ApplyType = typename details::key_value_apply_result<
+        ApplyFunction, KeyType, ValueType>::type,
+    typename std::enable_if<details::is_valid_key_value_apply_function<
+                                ApplyFunction, KeyType, ValueType>::value &&
+                                !std::is_same<void, ApplyType>::value,
+                            int>::type = 0>
+inline Grouped<KeyType, ApplyType> apply_map(std::map<KeyType, ValueType> &&map,
+                                             ApplyFunction &&f) {
+  Grouped<KeyType, ApplyType> output;
+  auto it = map.begin();
+  while (it != map.end()) {
+    output.emplace(it->first, f(it->first, std::move(it->second)));
+    it = map.erase(it);
+  }
+  return output;
+}
+
+template <typename KeyType, typename ValueType, typename ApplyFunction,
+          typename ApplyType = typename details::value_only_apply_result<
+              ApplyFunction, ValueType>::type,
+          typename std::enable_if<details::is_valid_value_only_apply_function<
+                                      ApplyFunction, ValueType>::value &&
+                                      !std::is_same<void, ApplyType>::value,
+                                  int>::type = 0>
+inline Grouped<KeyType, ApplyType> apply_map(std::map<KeyType, ValueType> &&map,
+                                             ApplyFunction &&f) {
+  Grouped<KeyType, ApplyType> output;
+  auto it = map.begin();
+  while (it != map.end()) {
+    output.emplace(it->first, f(std::move(it->second)));
+    it = map.erase(it);
+  }
+  return output;
+}
+
+// In Place Map
+
+template <typename KeyType, typename ValueType, typename ApplyFunction,
+          typename std::enable_if<
+              is_invocable<ApplyFunction, const KeyType &, ValueType &>::value,
+              int>::type = 0>
+inline void apply_map_in_place(std::map<KeyType, ValueType> *map,
+                               ApplyFunction &&f) {
+  for (auto &pair : *map) {
+    f(pair.first, pair.second);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename ApplyFunction,
+          typename std::enable_if<
+              is_invocable<ApplyFunction, ValueType &>::value &&
+                  !is_invocable<ApplyFunction, const KeyType &,
+                                ValueType &>::value,
+              int>::type = 0>
+inline void apply_map_in_place(std::map<KeyType, ValueType> *map,
+                               ApplyFunction &&f) {
+  for (auto &pair : *map) {
+    f(pair.second);
+  }
+}
+
 template <typename KeyType, typename ValueType, typename ApplyFunction>
 inline auto apply(const std::map<KeyType, ValueType> &map, ApplyFunction &&f) {
   return apply_map(map, std::forward<ApplyFunction>(f));
 }
 
+template <typename KeyType, typename ValueType, typename ApplyFunction>
+inline auto apply(std::map<KeyType, ValueType> &&map, ApplyFunction &&f) {
+  return apply_map(std::move(map), std::forward<ApplyFunction>(f));
+}
+
 template <typename KeyType, typename ValueType, typename ApplyFunction>
 inline auto apply(const Grouped<KeyType, ValueType> &map, ApplyFunction &&f) {
   return apply_map(map, std::forward<ApplyFunction>(f));
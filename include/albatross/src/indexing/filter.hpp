@@ -67,6 +67,33 @@ filter_map(const Map<KeyType, ValueType> &map, ToKeepFunction &&to_keep) {
   return output;
 }
 
+// In Place Map
+
+template <typename KeyType, typename ValueType, typename ToKeepFunction,
+          typename std::enable_if<details::is_valid_value_only_filter_function<
+                                      ToKeepFunction, ValueType>::value,
+                                  int>::type = 0>
+inline void filter_map_in_place(std::map<KeyType, ValueType> *map,
+                                ToKeepFunction &&to_keep) {
+  auto it = map->begin();
+  while (it != map->end()) {
+    it = to_keep(it->second) ? std::next(it) : map->erase(it);
+  }
+}
+
+template <
+    typename KeyType, typename ValueType, typename ToKeepFunction,
+    typename std::enable_if<details::is_valid_key_value_filter_function<
+                                ToKeepFunction, KeyType, ValueType>::value,
+                            int>::type = 0>
+inline void filter_map_in_place(std::map<KeyType, ValueType> *map,
+                                ToKeepFunction &&to_keep) {
+  auto it = map->begin();
+  while (it != map->end()) {
+    it = to_keep(it->first, it->second) ? std::next(it) : map->erase(it);
+  }
+}
+
 template <typename KeyType, typename ValueType, typename ToKeepFunction>
 inline auto filter(const std::map<KeyType, ValueType> &map,
                    ToKeepFunction &&f) {
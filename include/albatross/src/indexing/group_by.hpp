@@ -41,6 +41,9 @@ template <typename KeyType, typename ValueType> class GroupedBase {
 public:
   GroupedBase() : map_(){};
   GroupedBase(const GroupedBase &other) = default;
+  GroupedBase(GroupedBase &&other) = default;
+  GroupedBase &operator=(const GroupedBase &other) = default;
+  GroupedBase &operator=(GroupedBase &&other) = default;
   GroupedBase(std::map<KeyType, ValueType> &&map) : map_(std::move(map)){};
   GroupedBase(const std::map<KeyType, ValueType> &map) : map_(map){};
 
@@ -76,7 +79,9 @@ public:
 
   std::vector<ValueType> values() const { return map_values(map_); }
 
-  std::map<KeyType, ValueType> get_map() const { return map_; }
+  const std::map<KeyType, ValueType> &get_map() const & { return map_; }
+
+  std::map<KeyType, ValueType> get_map() && { return std::move(map_); }
 
   std::pair<KeyType, ValueType> first_group() const { return *map_.begin(); }
 
@@ -113,20 +118,41 @@ public:
    * groups you would like to keep.  This is done by providing a function which
    * returns bool when provided with a group (or group key and group)
    */
-  template <typename FilterFunction> auto filter(FilterFunction &&f) const {
+  template <typename FilterFunction> auto filter(FilterFunction &&f) const & {
     return albatross::filter(map_, std::forward<FilterFunction>(f));
   }
 
+  // When called on a temporary the groups which fail the filter are
+  // simply erased, avoiding copies of the values which are kept.
+  template <typename FilterFunction> auto filter(FilterFunction &&f) && {
+    albatross::filter_map_in_place(&map_, std::forward<FilterFunction>(f));
+    return Grouped<KeyType, ValueType>(std::move(map_));
+  }
+
   /*
    * Using Apply with Grouped objects consists of performing some operation
    * to each group.  This is done by provided a function which takes a group
    * (or group key and group).  If the function returns something other than
    * void the results will be aggregated into a new Grouped object.
    */
-  template <typename ApplyFunction> auto apply(ApplyFunction &&f) const {
+  template <typename ApplyFunction> auto apply(ApplyFunction &&f) const & {
     return albatross::apply(map_, std::forward<ApplyFunction>(f));
   }
 
+  // When called on a temporary each value is moved into the apply
+  // function and released as soon as it has been processed.
+  template <typename ApplyFunction> auto apply(ApplyFunction &&f) && {
+    return albatross::apply(std::move(map_), std::forward<ApplyFunction>(f));
+  }
+
+  /*
+   * Modifies each group in place, the function should take a non-const
+   * reference to the group (or group key and group).
+   */
+  template <typename ApplyFunction> void apply_in_place(ApplyFunction &&f) {
+    albatross::apply_map_in_place(&map_, std::forward<ApplyFunction>(f));
+  }
+
   template <typename ApplyFunction> auto async_apply(ApplyFunction &&f) const {
     return albatross::async_apply(map_, std::forward<ApplyFunction>(f));
   }
@@ -230,14 +256,88 @@ template <template <typename...> class Map, typename KeyType,
           typename FeatureType>
 RegressionDataset<FeatureType>
 combine(const Map<KeyType, RegressionDataset<FeatureType>> &groups) {
-  return concatenate_datasets(map_values(groups));
+  std::size_t size = 0;
+  for (const auto &pair : groups) {
+    size += pair.second.size();
+  }
+
+  std::vector<FeatureType> features;
+  features.reserve(size);
+  Eigen::VectorXd mean(static_cast<Eigen::Index>(size));
+  Eigen::VectorXd variance(static_cast<Eigen::Index>(size));
+  Eigen::Index i = 0;
+  for (const auto &pair : groups) {
+    const auto &dataset = pair.second;
+    const auto n = static_cast<Eigen::Index>(dataset.size());
+    features.insert(features.end(), dataset.features.begin(),
+                    dataset.features.end());
+    mean.segment(i, n) = dataset.targets.mean;
+    variance.segment(i, n) = dataset.targets.covariance.diagonal();
+    i += n;
+  }
+  return RegressionDataset<FeatureType>(
+      std::move(features), MarginalDistribution(mean, variance));
+}
+
+template <typename KeyType, typename FeatureType>
+RegressionDataset<FeatureType>
+combine(std::map<KeyType, RegressionDataset<FeatureType>> &&groups) {
+  std::size_t size = 0;
+  for (const auto &pair : groups) {
+    size += pair.second.size();
+  }
+
+  std::vector<FeatureType> features;
+  features.reserve(size);
+  Eigen::VectorXd mean(static_cast<Eigen::Index>(size));
+  Eigen::VectorXd variance(static_cast<Eigen::Index>(size));
+  Eigen::Index i = 0;
+  for (auto &pair : groups) {
+    auto &dataset = pair.second;
+    const auto n = static_cast<Eigen::Index>(dataset.size());
+    features.insert(features.end(),
+                    std::make_move_iterator(dataset.features.begin()),
+                    std::make_move_iterator(dataset.features.end()));
+    mean.segment(i, n) = dataset.targets.mean;
+    variance.segment(i, n) = dataset.targets.covariance.diagonal();
+    i += n;
+    // Release each group as soon as it has been combined.
+    dataset = RegressionDataset<FeatureType>();
+  }
+  return RegressionDataset<FeatureType>(
+      std::move(features), MarginalDistribution(mean, variance));
 }
 
 template <template <typename...> class Map, typename KeyType,
           typename FeatureType>
 std::vector<FeatureType>
 combine(const Map<KeyType, std::vector<FeatureType>> &groups) {
-  return concatenate(map_values(groups));
+  std::size_t size = 0;
+  for (const auto &pair : groups) {
+    size += pair.second.size();
+  }
+  std::vector<FeatureType> output;
+  output.reserve(size);
+  for (const auto &pair : groups) {
+    output.insert(output.end(), pair.second.begin(), pair.second.end());
+  }
+  return output;
+}
+
+template <typename KeyType, typename FeatureType>
+std::vector<FeatureType>
+combine(std::map<KeyType, std::vector<FeatureType>> &&groups) {
+  std::size_t size = 0;
+  for (const auto &pair : groups) {
+    size += pair.second.size();
+  }
+  std::vector<FeatureType> output;
+  output.reserve(size);
+  for (auto &pair : groups) {
+    output.insert(output.end(), std::make_move_iterator(pair.second.begin()),
+                  std::make_move_iterator(pair.second.end()));
+  }
+  return output;
 }
 
 template <template <typename...> class Map, typename KeyType>
@@ -262,7 +362,9 @@ public:
   using Base = GroupedBase<KeyType, ValueType>;
   using Base::Base;
 
-  ValueType combine() const { return albatross::combine(*this); }
+  ValueType combine() const & { return albatross::combine(this->map_); }
+
+  ValueType combine() && { return albatross::combine(std::move(this->map_)); }
 };
 
 template <typename KeyType, typename FeatureType>
@@ -402,7 +504,14 @@ public:
     indexers_ = build_indexers();
   };
 
-  IndexerType indexers() const { return indexers_; }
+  GroupByBase(ValueType &&parent, const GrouperType &grouper)
+      : parent_(std::move(parent)), grouper_(grouper) {
+    indexers_ = build_indexers();
+  };
+
+  const IndexerType &indexers() const & { return indexers_; }
+
+  IndexerType indexers() && { return std::move(indexers_); }
 
   Grouped<KeyType, ValueType> groups() const {
     Grouped<KeyType, ValueType> output;
@@ -561,6 +670,21 @@ auto group_by(const std::vector<FeatureType> &vector, GrouperFunc grouper) {
                                                         std::move(grouper));
 }
 
+/*
+ * Grouping a temporary takes ownership of it rather than making a copy.
+ */
+template <typename FeatureType, typename GrouperFunc>
+auto group_by(RegressionDataset<FeatureType> &&dataset, GrouperFunc grouper) {
+  return GroupBy<RegressionDataset<FeatureType>, GrouperFunc>(
+      std::move(dataset), std::move(grouper));
+}
+
+template <typename FeatureType, typename GrouperFunc>
+auto group_by(std::vector<FeatureType> &&vector, GrouperFunc grouper) {
+  return GroupBy<std::vector<FeatureType>, GrouperFunc>(std::move(vector),
+                                                        std::move(grouper));
+}
+
 } // namespace albatross
 
 #endif /* ALBATROSS_INDEXING_GROUPBY_HPP_ */
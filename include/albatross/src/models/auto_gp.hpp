@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_MODELS_AUTO_GP_H_
+#define INCLUDE_ALBATROSS_MODELS_AUTO_GP_H_
+
+/*
+ * The AutoGaussianProcess picks between an exact, patchwork and sparse
+ * Gaussian process each time it is fit.  The training features are
+ * split with a KD partition (see patchwork_partition.hpp), which serves
+ * both as the patches of the Patchwork GP and as the independent blocks
+ * of the Sparse GP, and the memory and time required by each engine are
+ * estimated from the number of features, their dimension and the
+ * resulting group sizes.
+ *
+ * The engines are considered in order of fidelity, exact, patchwork then
+ * sparse, and the first which fits inside both the memory budget and the
+ * latency target is used.  If none of them do the engine which overshoots
+ * its budgets by the smallest factor is used instead.  The estimates are
+ * rough operation counts which only need to be good enough to rank the
+ * engines and tell when one is far outside the budget.
+ */
+
+namespace albatross {
+
+typedef enum auto_gp_engine_e {
+  AUTO_GP_ENGINE_EXACT,
+  AUTO_GP_ENGINE_PATCHWORK,
+  AUTO_GP_ENGINE_SPARSE
+} auto_gp_engine_t;
+
+inline std::string to_string(const auto_gp_engine_t &engine) {
+  switch (engine) {
+  case AUTO_GP_ENGINE_EXACT:
+    return "exact";
+  case AUTO_GP_ENGINE_PATCHWORK:
+    return "patchwork";
+  case AUTO_GP_ENGINE_SPARSE:
+    return "sparse";
+  default:
+    assert(false);
+    return "unknown engine";
+  }
+}
+
+struct AutoGPConfig {
+  // Upper bound on the memory used while fitting.
+  std::size_t memory_budget_bytes = std::size_t(1) << 30;
+  // Desired wall time for a fit.
+  double latency_target_seconds = 1.;
+  // Sustained throughput used to turn operation counts into time.
+  double flops_per_second = 1e10;
+  // Largest patch (and independent block for the sparse engine) the
+  // KD partition is allowed to produce.
+  std::size_t max_patch_size = 1000;
+  // Approximate distance between boundary features of neighbouring patches.
+  double boundary_spacing = 1.;
+};
+
+struct AutoGPEstimate {
+  double memory_bytes = 0.;
+  double flops = 0.;
+  double seconds = 0.;
+
+  // The largest fraction of either budget this estimate would use,
+  // anything above one exceeds a budget.
+  double budget_fraction(const AutoGPConfig &config) const {
+    const double memory_budget =
+        static_cast<double>(config.memory_budget_bytes);
+    return std::max(memory_bytes / memory_budget,
+                    seconds / config.latency_target_seconds);
+  }
+};
+
+struct AutoGPPlan {
+  auto_gp_engine_t engine = AUTO_GP_ENGINE_EXACT;
+  bool within_budget = true;
+  std::size_t num_features = 0;
+  std::size_t feature_dimension = 0;
+  std::size_t num_patches = 0;
+  std::size_t max_patch_size = 0;
+  std::size_t num_boundary_features = 0;
+  std::size_t num_inducing_points = 0;
+  AutoGPEstimate exact;
+  AutoGPEstimate patchwork;
+  AutoGPEstimate sparse;
+
+  const AutoGPEstimate &chosen() const {
+    if (engine == AUTO_GP_ENGINE_PATCHWORK) {
+      return patchwork;
+    } else if (engine == AUTO_GP_ENGINE_SPARSE) {
+      return sparse;
+    }
+    return exact;
+  }
+
+  Insights insights() const {
+    Insights output;
+    output["engine"] = to_string(engine);
+    output["within_budget"] = within_budget ? "true" : "false";
+    output["num_features"] = std::to_string(num_features);
+    output["feature_dimension"] = std::to_string(feature_dimension);
+    output["num_patches"] = std::to_string(num_patches);
+    output["max_patch_size"] = std::to_string(max_patch_size);
+    output["num_boundary_features"] = std::to_string(num_boundary_features);
+    output["num_inducing_points"] = std::to_string(num_inducing_points);
+    auto add_estimate = [&](const auto_gp_engine_t &e,
+                            const AutoGPEstimate &estimate) {
+      output[to_string(e) + "_memory_bytes"] =
+          std::to_string(estimate.memory_bytes);
+      output[to_string(e) + "_seconds"] = std::to_string(estimate.seconds);
+    };
+    add_estimate(AUTO_GP_ENGINE_EXACT, exact);
+    add_estimate(AUTO_GP_ENGINE_PATCHWORK, patchwork);
+    add_estimate(AUTO_GP_ENGINE_SPARSE, sparse);
+    return output;
+  }
+};
+
+namespace details {
+
+constexpr double auto_gp_bytes_per_double = static_cast<double>(sizeof(double));
+
+inline AutoGPEstimate auto_gp_estimate(double doubles, double flops,
+                                       const AutoGPConfig &config) {
+  AutoGPEstimate estimate;
+  estimate.memory_bytes = auto_gp_bytes_per_double * doubles;
+  estimate.flops = flops;
+  estimate.seconds = flops / config.flops_per_second;
+  return estimate;
+}
+
+/*
+ * The dense covariance and its factorization, which costs n^3 / 3,
+ * plus d operations for each of the n^2 covariance evaluations.
+ */
+inline AutoGPEstimate exact_gp_estimate(double n, double d,
+                                        const AutoGPConfig &config) {
+  return auto_gp_estimate(2. * n * n, n * n * d + n * n * n / 3., config);
+}
+
+/*
+ * A factored covariance for each patch, the cross covariance between
+ * the data and the boundaries (C_db) along with C_dd^-1 C_db and the
+ * dense boundary system S_bb.
+ */
+inline AutoGPEstimate
+patchwork_gp_estimate(const std::vector<std::size_t> &patch_sizes, double b,
+                      double d, const AutoGPConfig &config) {
+  double n = 0.;
+  double doubles = 2. * b * b;
+  double flops = b * b * d + b * b * b / 3.;
+  for (const auto &size : patch_sizes) {
+    const double p = static_cast<double>(size);
+    n += p;
+    doubles += 2. * p * p;
+    flops += p * p * d + p * p * p / 3. + p * p * b;
+  }
+  doubles += 2. * n * b;
+  flops += n * b * d + n * b * b;
+  return auto_gp_estimate(doubles, flops, config);
+}
+
+/*
+ * The cross covariance between the data and the m inducing points, the
+ * factored independent blocks and the QR decomposition of the stacked
+ * (n + m) x m system.
+ */
+inline AutoGPEstimate
+sparse_gp_estimate(const std::vector<std::size_t> &block_sizes, double m,
+                   double d, const AutoGPConfig &config) {
+  double n = 0.;
+  double doubles = 3. * m * m;
+  double flops = m * m * d + m * m * m / 3.;
+  for (const auto &size : block_sizes) {
+    const double p = static_cast<double>(size);
+    n += p;
+    doubles += p * p;
+    flops += p * p * d + p * p * p / 3. + p * p * m;
+  }
+  doubles += 2. * n * m;
+  flops += n * m * d + 2. * (n + m) * m * m;
+  return auto_gp_estimate(doubles, flops, config);
+}
+
+inline auto_gp_engine_t choose_auto_gp_engine(const AutoGPPlan &plan,
+                                              const AutoGPConfig &config,
+                                              bool *within_budget) {
+  const std::vector<std::pair<auto_gp_engine_t, AutoGPEstimate>> candidates = {
+      {AUTO_GP_ENGINE_EXACT, plan.exact},
+      {AUTO_GP_ENGINE_PATCHWORK, plan.patchwork},
+      {AUTO_GP_ENGINE_SPARSE, plan.sparse}};
+
+  for (const auto &candidate : candidates) {
+    if (candidate.second.budget_fraction(config) <= 1.) {
+      *within_budget = true;
+      return candidate.first;
+    }
+  }
+
+  *within_budget = false;
+  auto best = candidates.front();
+  for (const auto &candidate : candidates) {
+    if (candidate.second.budget_fraction(config) <
+        best.second.budget_fraction(config)) {
+      best = candidate;
+    }
+  }
+  return best.first;
+}
+
+} // namespace details
+
+/*
+ * Assigns features to the leaves of a KD partition, this is used as the
+ * independent group function of the sparse engine.
+ */
+template <typename FeatureType> struct KDPartitionGrouper {
+
+  KDPartitionGrouper() : partition(){};
+
+  KDPartitionGrouper(const KDPartitionPatchworkFunctions<FeatureType> &p)
+      : partition(p){};
+
+  std::size_t operator()(const FeatureType &f) const {
+    return partition.grouper(f);
+  }
+
+  KDPartitionPatchworkFunctions<FeatureType> partition;
+};
+
+template <typename ExactFitModel, typename PatchworkFitModel,
+          typename SparseFitModel>
+struct AutoGPFit {};
+
+template <typename ExactFitModel, typename PatchworkFitModel,
+          typename SparseFitModel>
+struct Fit<AutoGPFit<ExactFitModel, PatchworkFitModel, SparseFitModel>> {
+
+  using FitModelVariant =
+      variant<ExactFitModel, PatchworkFitModel, SparseFitModel>;
+
+  Fit() : fit_model(), plan(){};
+
+  template <typename FitModelType>
+  Fit(FitModelType &&fit_model_, const AutoGPPlan &plan_)
+      : fit_model(std::forward<FitModelType>(fit_model_)), plan(plan_){};
+
+  FitModelVariant fit_model;
+  AutoGPPlan plan;
+};
+
+template <typename CovFunc, typename MeanFunc, typename InducingPointStrategy>
+class AutoGaussianProcess
+    : public GaussianProcessBase<
+          CovFunc, MeanFunc,
+          AutoGaussianProcess<CovFunc, MeanFunc, InducingPointStrategy>> {
+
+public:
+  using Base = GaussianProcessBase<
+      CovFunc, MeanFunc,
+      AutoGaussianProcess<CovFunc, MeanFunc, InducingPointStrategy>>;
+
+  AutoGaussianProcess() : Base(), config_(), inducing_point_strategy_(){};
+
+  AutoGaussianProcess(const CovFunc &covariance_function,
+                      const MeanFunc &mean_function,
+                      const AutoGPConfig &config,
+                      const InducingPointStrategy &inducing_point_strategy)
+      : Base(covariance_function, mean_function), config_(config),
+        inducing_point_strategy_(inducing_point_strategy) {
+    assert(config_.memory_budget_bytes > 0);
+    assert(config_.latency_target_seconds > 0.);
+    assert(config_.flops_per_second > 0.);
+  };
+
+  const AutoGPConfig &get_config() const { return config_; }
+
+  void set_config(const AutoGPConfig &config) { config_ = config; }
+
+  /*
+   * Estimates the cost of each engine for the given training features
+   * and decides which would be used to fit them.
+   */
+  template <typename FeatureType>
+  AutoGPPlan plan(const std::vector<FeatureType> &features) const {
+    return plan(features, partition(features));
+  }
+
+  template <typename FeatureType>
+  void record_plan_insights(const std::vector<FeatureType> &features) {
+    const auto new_insights = plan(features).insights();
+    for (const auto &pair : new_insights) {
+      this->insights[pair.first] = pair.second;
+    }
+  }
+
+  template <typename FeatureType>
+  auto _fit_impl(const std::vector<FeatureType> &features,
+                 const MarginalDistribution &targets) const {
+    const auto functions = partition(features);
+    const AutoGPPlan auto_plan = plan(features, functions);
+
+    auto exact = gp_from_covariance_and_mean(this->covariance_function_,
+                                             this->mean_function_);
+    PatchworkGaussianProcess<CovFunc, MeanFunc,
+                             KDPartitionPatchworkFunctions<FeatureType>>
+        patchwork(this->covariance_function_, this->mean_function_,
+                  functions);
+    auto sparse = sparse_gp_from_covariance_and_mean(
+        this->covariance_function_, this->mean_function_,
+        KDPartitionGrouper<FeatureType>(functions), inducing_point_strategy_,
+        this->get_name());
+
+    using FitType = Fit<AutoGPFit<decltype(exact.fit(features, targets)),
+                                  decltype(patchwork.fit(features, targets)),
+                                  decltype(sparse.fit(features, targets))>>;
+
+    // The chosen model carries the plan along with it so the decision
+    // can be inspected from the resulting FitModel.
+    const auto plan_insights = auto_plan.insights();
+    if (auto_plan.engine == AUTO_GP_ENGINE_PATCHWORK) {
+      patchwork.insights = plan_insights;
+      return FitType(patchwork.fit(features, targets), auto_plan);
+    } else if (auto_plan.engine == AUTO_GP_ENGINE_SPARSE) {
+      sparse.insights = plan_insights;
+      return FitType(sparse.fit(features, targets), auto_plan);
+    }
+    exact.insights = plan_insights;
+    return FitType(exact.fit(features, targets), auto_plan);
+  }
+
+  template <typename FeatureType, typename ExactFitModel,
+            typename PatchworkFitModel, typename SparseFitModel,
+            typename PredictType>
+  PredictType _predict_impl(
+      const std::vector<FeatureType> &features,
+      const Fit<AutoGPFit<ExactFitModel, PatchworkFitModel, SparseFitModel>>
+          &auto_fit,
+      PredictTypeIdentity<PredictType> &&) const {
+    return auto_fit.fit_model.match([&](const auto &fit_model) {
+      return fit_model.predict(features).template get<PredictType>();
+    });
+  }
+
+private:
+  template <typename FeatureType>
+  KDPartitionPatchworkFunctions<FeatureType>
+  partition(const std::vector<FeatureType> &features) const {
+    return kd_partition_patchwork_functions(features, config_.max_patch_size,
+                                            config_.boundary_spacing);
+  }
+
+  template <typename FeatureType>
+  AutoGPPlan
+  plan(const std::vector<FeatureType> &features,
+       const KDPartitionPatchworkFunctions<FeatureType> &functions) const {
+    assert(features.size() > 0);
+
+    AutoGPPlan output;
+    output.num_features = features.size();
+    output.feature_dimension =
+        static_cast<std::size_t>(details::kd_coordinates(features[0]).size());
+    output.num_patches = functions.number_of_groups();
+
+    std::vector<std::size_t> patch_sizes(output.num_patches, 0);
+    for (const auto &f : features) {
+      patch_sizes[functions.grouper(f)] += 1;
+    }
+    output.max_patch_size =
+        *std::max_element(patch_sizes.begin(), patch_sizes.end());
+
+    if (output.num_patches > 1) {
+      for (std::size_t i = 0; i < output.num_patches; ++i) {
+        for (std::size_t j = i + 1; j < output.num_patches; ++j) {
+          output.num_boundary_features += functions.boundary(i, j).size();
+        }
+      }
+    }
+
+    output.num_inducing_points =
+        inducing_point_strategy_(this->covariance_function_, features).size();
+
+    const double n = static_cast<double>(output.num_features);
+    const double d = static_cast<double>(output.feature_dimension);
+    const double b = static_cast<double>(output.num_boundary_features);
+    const double m = static_cast<double>(output.num_inducing_points);
+
+    output.exact = details::exact_gp_estimate(n, d, config_);
+    output.patchwork =
+        details::patchwork_gp_estimate(patch_sizes, b, d, config_);
+    output.sparse = details::sparse_gp_estimate(patch_sizes, m, d, config_);
+    output.engine = details::choose_auto_gp_engine(output, config_,
+                                                   &output.within_budget);
+    return output;
+  }
+
+  AutoGPConfig config_;
+  InducingPointStrategy inducing_point_strategy_;
+};
+
+template <typename CovFunc, typename MeanFunc, typename InducingPointStrategy>
+auto auto_gp_from_covariance_and_mean(
+    const CovFunc &covariance_function, const MeanFunc &mean_function,
+    const AutoGPConfig &config,
+    const InducingPointStrategy &inducing_point_strategy) {
+  return AutoGaussianProcess<CovFunc, MeanFunc, InducingPointStrategy>(
+      covariance_function, mean_function, config, inducing_point_strategy);
+};
+
+template <typename CovFunc, typename InducingPointStrategy>
+auto auto_gp_from_covariance(
+    const CovFunc &covariance_function, const AutoGPConfig &config,
+    const InducingPointStrategy &inducing_point_strategy) {
+  return auto_gp_from_covariance_and_mean(covariance_function, ZeroMean(),
+                                          config, inducing_point_strategy);
+};
+
+template <typename CovFunc>
+auto auto_gp_from_covariance(const CovFunc &covariance_function,
+                             const AutoGPConfig &config) {
+  return auto_gp_from_covariance(covariance_function, config,
+                                 StateSpaceInducingPointStrategy());
+};
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_MODELS_AUTO_GP_H_ */
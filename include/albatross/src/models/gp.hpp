@@ -71,6 +71,19 @@ struct Fit<GPFit<CovarianceRepresentation, FeatureType>> {
     information = train_covariance.solve(targets.mean);
   }
 
+  // Takes ownership of the prior covariance, which is typically large,
+  // and adds the target covariance to it in place instead of copying.
+  Fit(const std::vector<FeatureType> &features, Eigen::MatrixXd &&train_cov,
+      const DiagonalMatrixXd &targets_covariance,
+      const Eigen::VectorXd &zero_mean_targets)
+      : train_features(features) {
+    Eigen::MatrixXd cov(std::move(train_cov));
+    cov += targets_covariance;
+    assert(!cov.hasNaN());
+    train_covariance = CovarianceRepresentation(cov);
+    information = train_covariance.solve(zero_mean_targets);
+  }
+
   bool operator==(
       const Fit<GPFit<CovarianceRepresentation, FeatureType>> &other) const {
     return (train_features == other.train_features &&
@@ -79,6 +92,84 @@ struct Fit<GPFit<CovarianceRepresentation, FeatureType>> {
   }
 };
 
+/*
+ * The pieces an update adds to a Gaussian process fit.  Updating a fit
+ * with covariance A and information v using new features with cross
+ * covariance B and prior covariance C results in a BlockSymmetric
+ * covariance built from Ai_B = A^-1 B and the Schur complement
+ * S = C - B^T A^-1 B (plus the new measurement noise) and the information
+ *
+ *   |v - Ai_B S^-1 delta|
+ *   |    S^-1 delta     |
+ *
+ * where delta is the difference between the new targets and their prior
+ * prediction.  Recording only these lets online fits be checkpointed by
+ * appending a delta after each update instead of rewriting the entire
+ * (ever growing) fit.
+ */
+template <typename FeatureType> struct GPFitDelta {
+  std::vector<FeatureType> features;
+  Eigen::MatrixXd Ai_B;
+  Eigen::SerializableLDLT S;
+  Eigen::VectorXd Si_delta;
+
+  bool operator==(const GPFitDelta &other) const {
+    return (features == other.features && Ai_B == other.Ai_B &&
+            S == other.S && Si_delta == other.Si_delta);
+  }
+};
+
+template <typename FeatureType>
+inline Eigen::VectorXd
+updated_information(const Eigen::VectorXd &information,
+                    const GPFitDelta<FeatureType> &delta) {
+  Eigen::VectorXd output(information.size() + delta.Si_delta.size());
+  output.topRows(information.size()) =
+      information - delta.Ai_B * delta.Si_delta;
+  output.bottomRows(delta.Si_delta.size()) = delta.Si_delta;
+  return output;
+}
+
+/*
+ * A fit whose covariance has a type which doesn't depend on the number
+ * of updates applied to it, so deltas can be replayed onto it at run time.
+ */
+template <typename Solver, typename FeatureType>
+inline Fit<GPFit<AppendedBlockSymmetric<Solver>, FeatureType>>
+as_appendable_fit(const Fit<GPFit<Solver, FeatureType>> &fit) {
+  return Fit<GPFit<AppendedBlockSymmetric<Solver>, FeatureType>>(
+      fit.train_features, AppendedBlockSymmetric<Solver>(fit.train_covariance),
+      fit.information);
+}
+
+template <typename Solver, typename FeatureType>
+inline void apply_fit_delta(
+    const GPFitDelta<FeatureType> &delta,
+    Fit<GPFit<AppendedBlockSymmetric<Solver>, FeatureType>> *fit) {
+  assert(fit->train_covariance.rows() == fit->information.size());
+  fit->information = updated_information(fit->information, delta);
+  fit->train_covariance.append(delta.Ai_B, delta.S);
+  fit->train_features.insert(fit->train_features.end(), delta.features.begin(),
+                             delta.features.end());
+}
+
+/*
+ * Folds all the appended blocks back into a single LDLT, which gives a
+ * regular snapshot of the fit and resets the cost of solves (which grows
+ * with the number of appended blocks).  This requires refactorizing the
+ * full covariance so is meant to be done periodically, not after
+ * every update.
+ */
+template <typename FeatureType>
+inline Fit<GPFit<Eigen::SerializableLDLT, FeatureType>> compact_fit(
+    const Fit<GPFit<AppendedBlockSymmetric<Eigen::SerializableLDLT>,
+                    FeatureType>> &fit) {
+  return Fit<GPFit<Eigen::SerializableLDLT, FeatureType>>(
+      fit.train_features,
+      Eigen::SerializableLDLT(fit.train_covariance.reconstructedMatrix()),
+      fit.information);
+}
+
 /*
  * Gaussian Process Helper Functions.
  */
@@ -179,7 +270,8 @@ protected:
 
 public:
   GaussianProcessBase(const GaussianProcessBase &other)
-      : covariance_function_(other.covariance_function_),
+      : ModelBase<ImplType>(other),
+        covariance_function_(other.covariance_function_),
         mean_function_(other.mean_function_), model_name_(other.model_name_){};
 
   GaussianProcessBase()
@@ -291,11 +383,22 @@ public:
   CholeskyFit<FeatureType>
   _fit_impl(const std::vector<FeatureType> &features,
             const MarginalDistribution &targets) const {
+    return _fit_impl(features, MarginalDistribution(targets));
+  }
+
+  // Targets which are no longer needed by the caller have the mean
+  // function removed in place.
+  template <
+      typename FeatureType,
+      std::enable_if_t<
+          has_call_operator<CovFunc, FeatureType, FeatureType>::value, int> = 0>
+  CholeskyFit<FeatureType> _fit_impl(const std::vector<FeatureType> &features,
+                                     MarginalDistribution &&targets) const {
     const auto measurement_features = as_measurements(features);
     Eigen::MatrixXd cov = covariance_function_(measurement_features);
-    MarginalDistribution zero_mean_targets(targets);
-    mean_function_.remove_from(measurement_features, &zero_mean_targets.mean);
-    return CholeskyFit<FeatureType>(features, cov, zero_mean_targets);
+    mean_function_.remove_from(measurement_features, &targets.mean);
+    return CholeskyFit<FeatureType>(features, std::move(cov),
+                                    targets.covariance, targets.mean);
   }
 
   // If the covariance is NOT defined.
@@ -383,36 +486,61 @@ public:
           FeatureType,
           "CovFunc is not defined for FeatureType and FitFeatureType");
 
+  /*
+   * Computes what updating a fit with new data would add to it, see
+   * GPFitDelta.
+   */
   template <typename Solver, typename FeatureType, typename UpdateFeatureType>
-  auto _update_impl(const Fit<GPFit<Solver, FeatureType>> &fit,
-                    const std::vector<UpdateFeatureType> &features,
-                    const MarginalDistribution &targets) const {
-
-    const auto new_features = concatenate(fit.train_features, features);
+  GPFitDelta<UpdateFeatureType>
+  update_delta(const Fit<GPFit<Solver, FeatureType>> &fit,
+               const std::vector<UpdateFeatureType> &features,
+               const MarginalDistribution &targets) const {
 
     auto pred = this->_predict_impl(features, fit,
                                     PredictTypeIdentity<JointDistribution>());
 
     Eigen::VectorXd delta = targets.mean - pred.mean;
     pred.covariance += targets.covariance;
-    const auto S_ldlt = pred.covariance.ldlt();
 
     const Eigen::MatrixXd cross =
         covariance_function_(fit.train_features, features);
 
-    const auto new_covariance =
-        build_block_symmetric(fit.train_covariance, cross, S_ldlt);
+    GPFitDelta<UpdateFeatureType> output;
+    output.features = features;
+    output.S = Eigen::SerializableLDLT(pred.covariance);
+    output.Ai_B = fit.train_covariance.solve(cross);
+    output.Si_delta = output.S.solve(delta);
+    return output;
+  }
+
+  template <typename Solver, typename FeatureType, typename UpdateFeatureType>
+  auto _update_impl(const Fit<GPFit<Solver, FeatureType>> &fit,
+                    const std::vector<UpdateFeatureType> &features,
+                    const MarginalDistribution &targets) const {
 
-    const Eigen::VectorXd Si_delta = S_ldlt.solve(delta);
+    const auto delta = update_delta(fit, features, targets);
+    const auto new_features = concatenate(fit.train_features, features);
 
-    Eigen::VectorXd new_information(new_covariance.rows());
-    new_information.topRows(fit.train_covariance.rows()) =
-        fit.information - new_covariance.Ai_B * Si_delta;
-    new_information.bottomRows(S_ldlt.rows()) = Si_delta;
+    BlockSymmetric<Solver> new_covariance;
+    new_covariance.A = fit.train_covariance;
+    new_covariance.Ai_B = delta.Ai_B;
+    new_covariance.S = delta.S;
 
     using NewFeatureType = typename decltype(new_features)::value_type;
     using NewFitType = Fit<GPFit<BlockSymmetric<Solver>, NewFeatureType>>;
-    return NewFitType(new_features, new_covariance, new_information);
+    return NewFitType(new_features, new_covariance,
+                      updated_information(fit.information, delta));
+  }
+
+  // Updating an appendable fit keeps its type.
+  template <typename Solver, typename FeatureType>
+  auto _update_impl(
+      const Fit<GPFit<AppendedBlockSymmetric<Solver>, FeatureType>> &fit,
+      const std::vector<FeatureType> &features,
+      const MarginalDistribution &targets) const {
+    auto output = fit;
+    apply_fit_delta(update_delta(fit, features, targets), &output);
+    return output;
   }
 
   CovFunc get_covariance() const { return covariance_function_; }
@@ -548,6 +676,231 @@ gp_cross_validated_predictions(const RegressionDataset<FeatureType> &dataset,
   return output;
 }
 
+namespace details {
+
+DEFINE_CLASS_METHOD_TRAITS(compute_covariance);
+
+template <typename GPType, typename FeatureType,
+          typename std::enable_if<
+              has_compute_covariance<
+                  const GPType,
+                  const std::vector<Measurement<FeatureType>> &>::value,
+              int>::type = 0>
+inline Eigen::MatrixXd
+gp_train_covariance(const GPType &model,
+                    const std::vector<FeatureType> &features) {
+  return model.compute_covariance(as_measurements(features));
+}
+
+template <typename GPType, typename FeatureType,
+          typename std::enable_if<
+              !has_compute_covariance<
+                  const GPType,
+                  const std::vector<Measurement<FeatureType>> &>::value,
+              int>::type = 0>
+inline Eigen::MatrixXd
+gp_train_covariance(const GPType &model,
+                    const std::vector<FeatureType> &features) {
+  return model.compute_covariance(features);
+}
+
+inline Eigen::VectorXd
+sliced_gp_prediction(const Eigen::MatrixXd &cross_cov,
+                     const Eigen::MatrixXd &prior_cov,
+                     const Eigen::VectorXd &information,
+                     const Eigen::SerializableLDLT &train_covariance,
+                     PredictTypeIdentity<Eigen::VectorXd>) {
+  return gp_mean_prediction(cross_cov, information);
+}
+
+inline MarginalDistribution
+sliced_gp_prediction(const Eigen::MatrixXd &cross_cov,
+                     const Eigen::MatrixXd &prior_cov,
+                     const Eigen::VectorXd &information,
+                     const Eigen::SerializableLDLT &train_covariance,
+                     PredictTypeIdentity<MarginalDistribution>) {
+  return gp_marginal_prediction(cross_cov, prior_cov.diagonal(), information,
+                                train_covariance);
+}
+
+inline JointDistribution
+sliced_gp_prediction(const Eigen::MatrixXd &cross_cov,
+                     const Eigen::MatrixXd &prior_cov,
+                     const Eigen::VectorXd &information,
+                     const Eigen::SerializableLDLT &train_covariance,
+                     PredictTypeIdentity<JointDistribution>) {
+  return gp_joint_prediction(cross_cov, prior_cov, information,
+                             train_covariance);
+}
+
+/*
+ * The prior covariance between all the features in a dataset and, only
+ * if the model has terms which apply to measurements, the covariance
+ * used for training.  Measurement only terms are covariance functions
+ * in their own right so if they vanish on the diagonal they vanish
+ * everywhere, which makes it possible to check for them using O(n)
+ * evaluations and skip the second assembly when there are none.
+ */
+struct GPDatasetCovariance {
+  Eigen::MatrixXd prior;
+  // Empty unless it differs from the prior.
+  Eigen::MatrixXd measurement;
+
+  const Eigen::MatrixXd &train() const {
+    return measurement.size() > 0 ? measurement : prior;
+  }
+};
+
+template <typename GPType, typename FeatureType>
+inline GPDatasetCovariance
+gp_dataset_covariance(const GPType &model,
+                      const std::vector<FeatureType> &features) {
+  GPDatasetCovariance output;
+  output.prior = model.compute_covariance(features);
+
+  bool has_measurement_terms = false;
+  for (std::size_t i = 0; i < features.size() && !has_measurement_terms;
+       ++i) {
+    const std::vector<FeatureType> single = {features[i]};
+    has_measurement_terms = gp_train_covariance(model, single)(0, 0) !=
+                            model.compute_covariance(single)(0, 0);
+  }
+  if (has_measurement_terms) {
+    output.measurement = gp_train_covariance(model, features);
+  }
+  return output;
+}
+
+template <typename PredictType>
+inline PredictType sliced_gp_fold_prediction(
+    const GPDatasetCovariance &covariance, const Eigen::VectorXd &zero_mean,
+    const DiagonalMatrixXd &targets_covariance,
+    const GroupIndices &train_indices, const GroupIndices &test_indices,
+    PredictTypeIdentity<PredictType> identity) {
+  Eigen::MatrixXd cov = symmetric_subset(covariance.train(), train_indices);
+  cov += symmetric_subset(targets_covariance, train_indices);
+  const Eigen::SerializableLDLT train_ldlt(cov);
+  const Eigen::VectorXd information =
+      train_ldlt.solve(subset(zero_mean, train_indices));
+
+  return sliced_gp_prediction(
+      subset(covariance.prior, train_indices, test_indices),
+      symmetric_subset(covariance.prior, test_indices), information,
+      train_ldlt, identity);
+}
+
+inline Eigen::VectorXd &prediction_mean(Eigen::VectorXd &prediction) {
+  return prediction;
+}
+
+template <typename DistributionType>
+inline Eigen::VectorXd &prediction_mean(DistributionType &prediction) {
+  return prediction.mean;
+}
+
+} // namespace details
+
+/*
+ * Cross validated predictions for Gaussian process backed models which
+ * assemble the covariance between all features once, up front, and then
+ * slice out the train, cross and test blocks for each fold.  Unlike
+ * gp_cross_validated_predictions this repeats the factorization of the
+ * training covariance for each fold, but it doesn't rely on the fold
+ * fit being a sub problem of a single fit to the entire dataset, so it
+ * only requires the model to provide `compute_covariance` and `get_mean`.
+ *
+ * If the model has terms which only apply to measurements (such as
+ * measurement noise) the training covariance differs from the prior
+ * covariance used for the cross and test blocks.  In that case both
+ * n x n matrices are assembled and kept alive for all folds, doubling
+ * the kernel evaluations and memory, see details::gp_dataset_covariance.
+ */
+template <typename FeatureType, typename GPType, typename GroupKey,
+          typename PredictType>
+std::map<GroupKey, PredictType>
+gp_cross_validated_predictions_reusing_covariance(
+    const RegressionDataset<FeatureType> &dataset,
+    const GroupIndexer<GroupKey> &group_indexer, const GPType &model,
+    PredictTypeIdentity<PredictType>) {
+
+  Eigen::VectorXd zero_mean(dataset.targets.mean);
+  model.get_mean().remove_from(dataset.features, &zero_mean);
+
+  const auto covariance =
+      details::gp_dataset_covariance(model, dataset.features);
+
+  std::map<GroupKey, PredictType> output;
+  for (const auto &pair : group_indexer) {
+    const auto &test_indices = pair.second;
+    const auto train_indices =
+        indices_complement(test_indices, dataset.size());
+
+    auto prediction = details::sliced_gp_fold_prediction(
+        covariance, zero_mean, dataset.targets.covariance, train_indices,
+        test_indices, PredictTypeIdentity<PredictType>());
+    model.get_mean().add_to(subset(dataset.features, test_indices),
+                            &details::prediction_mean(prediction));
+    output[pair.first] = prediction;
+  }
+  return output;
+}
+
+/*
+ * Cross validation of a Gaussian process wrapped in Ransac which assembles
+ * the covariance between all features once.  For each fold the RANSAC
+ * candidate fits, consensus metrics and the final fit to the consensus
+ * are all served by slicing that covariance, which gives the same
+ * predictions as refitting the Ransac model for every fold.  This is
+ * used by CrossValidation::predictions_reusing_covariance.
+ */
+template <typename FeatureType, typename ModelType, typename InlierMetric,
+          typename ConsensusMetric, typename IsValidCandidateMetric,
+          typename GrouperFunction, typename GroupKey, typename PredictType>
+std::map<GroupKey, PredictType>
+gp_cross_validated_predictions_reusing_covariance(
+    const RegressionDataset<FeatureType> &dataset,
+    const GroupIndexer<GroupKey> &group_indexer,
+    const Ransac<ModelType,
+                 GaussianProcessRansacStrategy<InlierMetric, ConsensusMetric,
+                                               IsValidCandidateMetric,
+                                               GrouperFunction>> &model,
+    PredictTypeIdentity<PredictType> identity) {
+
+  const auto &sub_model = model.sub_model_;
+  Eigen::VectorXd zero_mean(dataset.targets.mean);
+  sub_model.get_mean().remove_from(dataset.features, &zero_mean);
+
+  const auto covariance =
+      details::gp_dataset_covariance(sub_model, dataset.features);
+
+  std::map<GroupKey, PredictType> output;
+  for (const auto &pair : group_indexer) {
+    const auto &test_indices = pair.second;
+    const auto train_indices =
+        indices_complement(test_indices, dataset.size());
+    const auto train_dataset = subset(dataset, train_indices);
+
+    const auto indexer = model.strategy_.get_indexer(train_dataset);
+    const auto ransac_functions = model.strategy_(
+        sub_model, train_dataset,
+        symmetric_subset(covariance.prior, train_indices));
+    const auto ransac_output = ransac(ransac_functions, indexer, model.config_);
+    // As when predicting with a failed Ransac fit it's up to the user to
+    // make sure RANSAC can succeed.
+    assert(ransac_success(ransac_output.return_code));
+
+    const GroupIndices consensus_indices = subset(
+        train_indices, indices_from_groups(indexer, ransac_output.inliers));
+    auto prediction = details::sliced_gp_fold_prediction(
+        covariance, zero_mean, dataset.targets.covariance, consensus_indices,
+        test_indices, identity);
+    sub_model.get_mean().add_to(subset(dataset.features, test_indices),
+                                &details::prediction_mean(prediction));
+    output[pair.first] = prediction;
+  }
+  return output;
+}
+
 /*
  * Generic Gaussian Process Implementation.
  */
@@ -613,7 +966,7 @@ struct GaussianProcessNegativeLogLikelihood {
   double operator()(
       const RegressionDataset<FeatureType> &dataset,
       const GaussianProcessBase<CovFunc, MeanFunc, GPImplType> &model) const {
-    return -model.log_likelihood(dataset);
+    return -model.derived().log_likelihood(dataset);
   }
 };
 
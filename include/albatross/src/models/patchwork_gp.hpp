@@ -126,7 +126,8 @@ auto patchwork_solver_from_v(
     const Grouped<GroupKey, Solver> &A,
     const Grouped<GroupKey, Eigen::MatrixXd> &C,
     const Eigen::SerializableLDLT &S,
-    const Grouped<GroupKey, Eigen::Matrix<double, Rows, Cols>> &v) {
+    const Grouped<GroupKey, Eigen::Matrix<double, Rows, Cols>> &v,
+    bool use_async = false) {
   // This solves a matrix which takes the form:
   //
   //     (A - C B^-1 C^T)^{-1}
@@ -154,18 +155,24 @@ auto patchwork_solver_from_v(
   //   u = S^-1 C^T v  (dense)
   //   w = A^-1 C U    (grouped)
   //   output = w + v
+  //
+  // With use_async the per group work is spread over several threads.
 
   // u = S^-1 C^T v
   auto compute_u_block = [&](const Eigen::MatrixXd &C_i, const auto &v_i) {
     return Eigen::MatrixXd(S.solve(C_i.transpose() * v_i));
   };
-  const Eigen::MatrixXd u = block_accumulate(C, v, compute_u_block);
+  const Eigen::MatrixXd u = use_async
+                                ? async_block_accumulate(C, v, compute_u_block)
+                                : block_accumulate(C, v, compute_u_block);
 
   // w = A^-1 C u
   auto compute_Cu_block = [&](const auto &key, const auto &C_i) {
     return Eigen::MatrixXd(C_i * u);
   };
-  const auto w = block_diag_solve(A, C.apply(compute_Cu_block));
+  const auto Cu = C.apply(compute_Cu_block);
+  const auto w =
+      use_async ? async_block_diag_solve(A, Cu) : block_diag_solve(A, Cu);
   // output = w + z
   auto add_z = [&](const auto &key, const auto &w_block) {
     return Eigen::MatrixXd(w_block + v.at(key)).eval();
@@ -178,12 +185,155 @@ auto patchwork_solver(
     const Grouped<GroupKey, Solver> &A,
     const Grouped<GroupKey, Eigen::MatrixXd> &C,
     const Eigen::SerializableLDLT &S,
-    const Grouped<GroupKey, Eigen::Matrix<double, Rows, Cols>> &rhs) {
+    const Grouped<GroupKey, Eigen::Matrix<double, Rows, Cols>> &rhs,
+    bool use_async = false) {
   // v = A^-1 rhs
-  const auto v = block_diag_solve(A, rhs);
-  return patchwork_solver_from_v(A, C, S, v);
+  const auto v =
+      use_async ? async_block_diag_solve(A, rhs) : block_diag_solve(A, rhs);
+  return patchwork_solver_from_v(A, C, S, v, use_async);
 }
 
+namespace details {
+
+/*
+ * Computes the diagonal blocks of the inverse of the patchwork covariance
+ * corresponding to each set of (training) indices in `blocks`.  By the
+ * same matrix inversion lemma used in patchwork_solver_from_v,
+ *
+ *   (A - C B^-1 C^T)^-1 = A^-1 + W S^-1 W^T
+ *
+ * with W = A^-1 C, so a diagonal block of the inverse is made up of the
+ * corresponding blocks of the (block diagonal) A^-1, which are extracted
+ * from the per patch factorizations, plus a low rank boundary correction.
+ * The indices in `patch_indexer` define which patch each training index
+ * belongs to.
+ */
+template <typename GroupKey, typename Solver>
+std::vector<Eigen::MatrixXd>
+patchwork_inverse_blocks(const Grouped<GroupKey, Solver> &A,
+                         const Grouped<GroupKey, Eigen::MatrixXd> &C,
+                         const Eigen::SerializableLDLT &S,
+                         const GroupIndexer<GroupKey> &patch_indexer,
+                         const std::vector<GroupIndices> &blocks) {
+
+  std::size_t n = 0;
+  for (const auto &pair : patch_indexer) {
+    n += pair.second.size();
+  }
+
+  // Locate each training index within its patch.
+  std::vector<const GroupKey *> patch_of(n, nullptr);
+  std::vector<std::size_t> position_in_patch(n);
+  for (const auto &pair : patch_indexer) {
+    for (std::size_t j = 0; j < pair.second.size(); ++j) {
+      patch_of[pair.second[j]] = &pair.first;
+      position_in_patch[pair.second[j]] = j;
+    }
+  }
+
+  // Split each block into the pieces which fall in each patch so that
+  // all the pieces from a single patch can be extracted at once.
+  struct Piece {
+    std::size_t block;
+    GroupIndices rows;
+    GroupIndices positions;
+  };
+
+  std::map<GroupKey, std::vector<Piece>> pieces;
+  for (std::size_t b = 0; b < blocks.size(); ++b) {
+    std::map<GroupKey, Piece> block_pieces;
+    for (std::size_t r = 0; r < blocks[b].size(); ++r) {
+      const std::size_t index = blocks[b][r];
+      assert(index < n && patch_of[index] != nullptr);
+      auto &piece = block_pieces[*patch_of[index]];
+      piece.block = b;
+      piece.rows.push_back(r);
+      piece.positions.push_back(position_in_patch[index]);
+    }
+    for (auto &pair : block_pieces) {
+      pieces[pair.first].emplace_back(std::move(pair.second));
+    }
+  }
+
+  const Eigen::Index n_boundary = S.rows();
+  std::vector<Eigen::MatrixXd> output;
+  std::vector<Eigen::MatrixXd> W_blocks;
+  for (const auto &block : blocks) {
+    const Eigen::Index size = static_cast<Eigen::Index>(block.size());
+    output.emplace_back(Eigen::MatrixXd::Zero(size, size));
+    W_blocks.emplace_back(Eigen::MatrixXd::Zero(size, n_boundary));
+  }
+
+  for (const auto &pair : pieces) {
+    const auto &A_i = A.at(pair.first);
+    const Eigen::MatrixXd W_i = A_i.solve(C.at(pair.first));
+
+    std::vector<GroupIndices> positions;
+    for (const auto &piece : pair.second) {
+      positions.push_back(piece.positions);
+    }
+    const auto A_inv_blocks = A_i.inverse_blocks(positions);
+
+    for (std::size_t k = 0; k < pair.second.size(); ++k) {
+      const auto &piece = pair.second[k];
+      const auto &rows = piece.rows;
+      for (std::size_t r = 0; r < rows.size(); ++r) {
+        const auto row = static_cast<Eigen::Index>(rows[r]);
+        for (std::size_t c = 0; c < rows.size(); ++c) {
+          const auto col = static_cast<Eigen::Index>(rows[c]);
+          output[piece.block](row, col) = A_inv_blocks[k](r, c);
+        }
+        W_blocks[piece.block].row(row) =
+            W_i.row(static_cast<Eigen::Index>(piece.positions[r]));
+      }
+    }
+  }
+
+  for (std::size_t b = 0; b < blocks.size(); ++b) {
+    output[b] += W_blocks[b] * S.solve(W_blocks[b].transpose());
+  }
+  return output;
+}
+
+/*
+ * Given the block, A, of the inverse training covariance corresponding
+ * to a held out group, the (zero mean) targets, y, and information vector,
+ * v, of that group, the held out prediction is:
+ *
+ *   mean = y - A^-1 v
+ *   cov = A^-1
+ */
+inline Eigen::VectorXd
+held_out_prediction(const Eigen::MatrixXd &inverse_block,
+                    const Eigen::VectorXd &y, const Eigen::VectorXd &v,
+                    const Eigen::VectorXd &prior_mean,
+                    PredictTypeIdentity<Eigen::VectorXd>) {
+  const auto A_ldlt = Eigen::SerializableLDLT(inverse_block.ldlt());
+  return y - A_ldlt.solve(v) + prior_mean;
+}
+
+inline MarginalDistribution
+held_out_prediction(const Eigen::MatrixXd &inverse_block,
+                    const Eigen::VectorXd &y, const Eigen::VectorXd &v,
+                    const Eigen::VectorXd &prior_mean,
+                    PredictTypeIdentity<MarginalDistribution>) {
+  const auto A_ldlt = Eigen::SerializableLDLT(inverse_block.ldlt());
+  const Eigen::VectorXd mean = y - A_ldlt.solve(v) + prior_mean;
+  return MarginalDistribution(mean, A_ldlt.inverse_diagonal());
+}
+
+inline JointDistribution
+held_out_prediction(const Eigen::MatrixXd &inverse_block,
+                    const Eigen::VectorXd &y, const Eigen::VectorXd &v,
+                    const Eigen::VectorXd &prior_mean,
+                    PredictTypeIdentity<JointDistribution>) {
+  const Eigen::MatrixXd A_inv = inverse_block.inverse();
+  const Eigen::VectorXd mean = y - A_inv * v + prior_mean;
+  return JointDistribution(mean, A_inv);
+}
+
+} // namespace details
+
 template <typename CovFunc, typename MeanFunc, typename PatchworkFunctions>
 class PatchworkGaussianProcess
     : public GaussianProcessBase<
@@ -201,6 +351,11 @@ public:
   PatchworkGaussianProcess(CovFunc &covariance_function,
                            PatchworkFunctions patchwork_functions)
       : Base(covariance_function), patchwork_functions_(patchwork_functions){};
+  PatchworkGaussianProcess(const CovFunc &covariance_function,
+                           const MeanFunc &mean_function,
+                           PatchworkFunctions patchwork_functions)
+      : Base(covariance_function, mean_function),
+        patchwork_functions_(patchwork_functions){};
 
   template <typename FitModelType, typename GroupKey>
   auto
@@ -267,7 +422,10 @@ public:
 
     // S_bb = C_bb - C_db^T * C_dd^-1 * C_db
     const Eigen::MatrixXd S_bb =
-        C_bb - block_inner_product(C_db, block_diag_solve(C_dd, C_db));
+        C_bb - (Base::use_async_
+                    ? async_block_inner_product(
+                          C_db, async_block_diag_solve(C_dd, C_db))
+                    : block_inner_product(C_db, block_diag_solve(C_dd, C_db)));
     const Eigen::SerializableLDLT S_bb_ldlt(S_bb.ldlt());
 
     // Similar to with a Gaussian process we can precompute the "information"
@@ -292,7 +450,8 @@ public:
     };
     const auto vs = fit_models.apply(get_v);
     // information = (C_dd - Cdb C_bb^-1 C_bd)^-1 ys
-    const auto information = patchwork_solver_from_v(C_dd, C_db, S_bb_ldlt, vs);
+    const auto information = patchwork_solver_from_v(C_dd, C_db, S_bb_ldlt, vs,
+                                                     Base::use_async_);
 
     return ReturnType(*this, PatchworkFitType(fit_models, information,
                                               boundary_features, C_dd, C_db,
@@ -318,11 +477,178 @@ public:
       return patchwork_functions_.grouper(f);
     };
 
-    const auto fit_models = dataset.group_by(grouper).apply(create_fit_model);
+    const auto fit_models =
+        Base::use_async_
+            ? dataset.group_by(grouper).async_apply(create_fit_model)
+            : dataset.group_by(grouper).apply(create_fit_model);
 
     return from_fit_models(fit_models).get_fit();
   }
 
+  /*
+   * Fits each patch in a separate worker process (see process_apply)
+   * which keeps the peak memory of the individual patch fits out of the
+   * calling process.  This requires including albatross/utils/ProcessUtils
+   * and albatross/serialize/GP so the patch fits can be sent back.
+   */
+  template <typename FeatureType>
+  auto fit_with_processes(const RegressionDataset<FeatureType> &dataset,
+                          std::size_t max_processes = 0) const {
+    const auto m = gp_from_covariance_and_mean(this->covariance_function_,
+                                               this->mean_function_);
+    using PatchFitModel = decltype(m.fit(dataset));
+    using PatchFit = typename PatchFitModel::fit_type;
+
+    auto fit_one_patch = [&](const RegressionDataset<FeatureType> &patch) {
+      return m.fit(patch).get_fit();
+    };
+
+    auto grouper = [&](const auto &f) {
+      return patchwork_functions_.grouper(f);
+    };
+
+    auto patch_fits = process_apply(dataset.group_by(grouper).groups(),
+                                    fit_one_patch, max_processes);
+
+    auto as_fit_model = [&](PatchFit fit) {
+      return PatchFitModel(m, std::move(fit));
+    };
+    return from_fit_models(std::move(patch_fits).apply(as_fit_model));
+  }
+
+  /*
+   * The log likelihood of the data under the patchwork model, which is
+   * the likelihood of the data given that all the boundary constraints
+   * hold.  This is computed from the per patch factorizations and the
+   * boundary system so the covariance of the full dataset is never formed.
+   */
+  template <typename FeatureType>
+  double log_likelihood(const RegressionDataset<FeatureType> &dataset) const {
+
+    const auto patchwork_fit = this->fit(dataset).get_fit();
+
+    auto grouper = [&](const auto &f) {
+      return patchwork_functions_.grouper(f);
+    };
+    const auto datasets = dataset.group_by(grouper).groups();
+
+    const bool has_boundaries = patchwork_fit.fit_models.size() > 1;
+
+    // The likelihood for y ~ N(0, K) is:
+    //
+    //   L = -1/2 (n log(2 pi) + log(|K|) + y^T K^-1 y)
+    //
+    // where for the patchwork model
+    //
+    //   K = C_dd - C_db C_bb^-1 C_bd
+    //
+    // The matrix determinant lemma gives us
+    //
+    //   |K| = |C_dd| |C_bb - C_bd C_dd^-1 C_db| / |C_bb|
+    //       = |C_dd| |S_bb| / |C_bb|
+    //
+    // and since C_dd is block diagonal |C_dd| is the product of the
+    // determinants of each patch.  The information vector is already
+    // K^-1 y so the quadratic term is a sum of per patch dot products.
+    auto log_likelihood_one_group = [&](const auto &key,
+                                        const auto &group_dataset) {
+      Eigen::VectorXd y(group_dataset.targets.mean);
+      this->mean_function_.remove_from(as_measurements(group_dataset.features),
+                                       &y);
+
+      double log_det;
+      Eigen::VectorXd information;
+      if (has_boundaries) {
+        log_det = patchwork_fit.C_dd.at(key).log_determinant();
+        information = patchwork_fit.information.at(key);
+      } else {
+        const auto gp_fit = patchwork_fit.fit_models.at(key).get_fit();
+        log_det = gp_fit.train_covariance.log_determinant();
+        information = gp_fit.information;
+      }
+
+      const double rank = static_cast<double>(y.size());
+      return -0.5 * (log_det + y.dot(information) + rank * log(2 * M_PI));
+    };
+
+    const auto patch_log_likelihoods =
+        Base::use_async_ ? datasets.async_apply(log_likelihood_one_group)
+                         : datasets.apply(log_likelihood_one_group);
+
+    double ll = patch_log_likelihoods.sum();
+    if (has_boundaries) {
+      ll -= 0.5 * (patchwork_fit.S_bb_ldlt.log_determinant() -
+                   patchwork_fit.C_bb_ldlt.log_determinant());
+    }
+    return ll + this->prior_log_likelihood();
+  }
+
+  /*
+   * Held out predictions for each group in `group_indexer` under the
+   * patchwork covariance of the full dataset,
+   *
+   *   K = C_dd - C_db C_bb^-1 C_bd
+   *
+   * This is the patchwork analog of gp_cross_validated_predictions, the
+   * required blocks of K^-1 are extracted from the patchwork solver
+   * (see details::patchwork_inverse_blocks) so K is never formed.  Note
+   * that the patches and boundaries are those of the full dataset, the
+   * model is not refit without each held out group.
+   */
+  template <typename FeatureType, typename PredictType, typename GroupKey>
+  std::map<GroupKey, PredictType>
+  cross_validated_predictions(const RegressionDataset<FeatureType> &dataset,
+                              const GroupIndexer<GroupKey> &group_indexer,
+                              PredictTypeIdentity<PredictType> identity) const {
+
+    const auto patchwork_fit = this->fit(dataset).get_fit();
+
+    if (patchwork_fit.fit_models.size() == 1) {
+      // Without boundaries this is just a Gaussian process.
+      const auto m = gp_from_covariance_and_mean(this->covariance_function_,
+                                                 this->mean_function_);
+      return gp_cross_validated_predictions(dataset, group_indexer, m,
+                                            identity);
+    }
+
+    auto grouper = [&](const auto &f) {
+      return patchwork_functions_.grouper(f);
+    };
+    const auto patch_indexer = dataset.group_by(grouper).indexers();
+
+    // Gather the per patch information vectors in dataset order.
+    Eigen::VectorXd information(dataset.size());
+    for (const auto &pair : patch_indexer) {
+      const auto &patch_information = patchwork_fit.information.at(pair.first);
+      for (std::size_t j = 0; j < pair.second.size(); ++j) {
+        information[static_cast<Eigen::Index>(pair.second[j])] =
+            patch_information(static_cast<Eigen::Index>(j), 0);
+      }
+    }
+
+    const auto measurement_features = as_measurements(dataset.features);
+    Eigen::VectorXd zero_mean(dataset.targets.mean);
+    this->mean_function_.remove_from(measurement_features, &zero_mean);
+
+    const std::vector<GroupIndices> indices = map_values(group_indexer);
+    const std::vector<GroupKey> group_keys = map_keys(group_indexer);
+    const auto inverse_blocks = details::patchwork_inverse_blocks(
+        patchwork_fit.C_dd, patchwork_fit.C_db, patchwork_fit.S_bb_ldlt,
+        patch_indexer, indices);
+
+    std::map<GroupKey, PredictType> output;
+    for (std::size_t i = 0; i < inverse_blocks.size(); i++) {
+      const Eigen::VectorXd yi = subset(zero_mean, indices[i]);
+      const Eigen::VectorXd vi = subset(information, indices[i]);
+      Eigen::VectorXd prior_mean_i = Eigen::VectorXd::Zero(yi.size());
+      this->mean_function_.add_to(subset(measurement_features, indices[i]),
+                                  &prior_mean_i);
+      output[group_keys[i]] = details::held_out_prediction(
+          inverse_blocks[i], yi, vi, prior_mean_i, identity);
+    }
+    return output;
+  }
+
   template <typename FeatureType, typename FitModelType, typename GroupKey,
             typename BoundaryFeatureType>
   JointDistribution _predict_impl(
@@ -392,15 +718,20 @@ public:
     const auto cross_transpose =
         patchwork_fit.fit_models.apply(compute_cross_transpose);
 
+    const auto inner_product = [this](const auto &lhs, const auto &rhs) {
+      return Base::use_async_ ? async_block_inner_product(lhs, rhs)
+                              : block_inner_product(lhs, rhs);
+    };
+
     const Eigen::VectorXd mean =
-        block_inner_product(cross_transpose, patchwork_fit.information);
+        inner_product(cross_transpose, patchwork_fit.information);
 
     // This is Equation 7 but split into a few steps.
-    const auto patchwork_solve_cross_transpose =
-        patchwork_solver(patchwork_fit.C_dd, patchwork_fit.C_db,
-                         patchwork_fit.S_bb_ldlt, cross_transpose);
+    const auto patchwork_solve_cross_transpose = patchwork_solver(
+        patchwork_fit.C_dd, patchwork_fit.C_db, patchwork_fit.S_bb_ldlt,
+        cross_transpose, Base::use_async_);
     const Eigen::MatrixXd explained =
-        block_inner_product(cross_transpose, patchwork_solve_cross_transpose);
+        inner_product(cross_transpose, patchwork_solve_cross_transpose);
     const Eigen::MatrixXd cov =
         patchwork_covariance_matrix(group_features, group_features) - C_fb * Q -
         explained;
@@ -0,0 +1,374 @@
+/*
+ * Copyright (C) 2019 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_MODELS_PATCHWORK_PARTITION_H_
+#define INCLUDE_ALBATROSS_MODELS_PATCHWORK_PARTITION_H_
+
+/*
+ * The cost of fitting a Patchwork Gaussian Process is dominated by the
+ * largest patch, so hand written groupers which produce a few oversized
+ * patches can easily erase the benefit of splitting up the problem.  The
+ * KDPartitionPatchworkFunctions defined here build the grouper, boundary
+ * and nearest_group methods required by PatchworkGaussianProcess directly
+ * from the training features by recursively splitting the data at the
+ * median of the dimension with the largest spread until every patch holds
+ * at most a target number of features.
+ *
+ * Boundaries are placed on the split planes shared by two neighbouring
+ * patches with roughly `boundary_spacing` between boundary features.
+ */
+
+namespace albatross {
+
+namespace details {
+
+/*
+ * Coordinate access for the feature types a KD partition can split.
+ */
+inline Eigen::VectorXd kd_coordinates(const double &x) {
+  Eigen::VectorXd output(1);
+  output << x;
+  return output;
+}
+
+template <int Rows>
+inline Eigen::VectorXd kd_coordinates(const Eigen::Matrix<double, Rows, 1> &x) {
+  return x;
+}
+
+template <typename FeatureType> struct KDFeatureFromCoordinates {};
+
+template <> struct KDFeatureFromCoordinates<double> {
+  static double create(const Eigen::VectorXd &coordinates) {
+    return coordinates[0];
+  }
+};
+
+template <int Rows>
+struct KDFeatureFromCoordinates<Eigen::Matrix<double, Rows, 1>> {
+  static Eigen::Matrix<double, Rows, 1>
+  create(const Eigen::VectorXd &coordinates) {
+    return coordinates;
+  }
+};
+
+struct KDPartitionNode {
+  // Index of the parent node, negative for the root.
+  int parent;
+  // Indices of the children, negative for leaf nodes.
+  int left;
+  int right;
+  std::size_t depth;
+  Eigen::Index split_dimension;
+  double split_value;
+  // The extent of the cell this node covers, clipped to the
+  // bounding box of the training features.
+  Eigen::VectorXd lower;
+  Eigen::VectorXd upper;
+  // Only meaningful for leaves.
+  std::size_t group;
+
+  bool is_leaf() const { return left < 0; }
+};
+
+} // namespace details
+
+template <typename FeatureType> class KDPartitionPatchworkFunctions {
+
+public:
+  using GroupKey = std::size_t;
+
+  KDPartitionPatchworkFunctions()
+      : nodes_(), leaves_(), boundary_spacing_(1.){};
+
+  KDPartitionPatchworkFunctions(const std::vector<FeatureType> &features,
+                                std::size_t max_patch_size,
+                                double boundary_spacing)
+      : nodes_(), leaves_(), boundary_spacing_(boundary_spacing) {
+    assert(features.size() > 0);
+    assert(max_patch_size > 0);
+    assert(boundary_spacing > 0.);
+
+    std::vector<Eigen::VectorXd> points;
+    for (const auto &f : features) {
+      points.emplace_back(details::kd_coordinates(f));
+    }
+
+    Eigen::VectorXd lower = points[0];
+    Eigen::VectorXd upper = points[0];
+    for (const auto &p : points) {
+      lower = lower.cwiseMin(p);
+      upper = upper.cwiseMax(p);
+    }
+
+    std::vector<std::size_t> inds(points.size());
+    std::iota(inds.begin(), inds.end(), 0);
+    build(points, &inds, 0, inds.size(), max_patch_size, -1, lower, upper);
+  }
+
+  GroupKey grouper(const FeatureType &f) const {
+    return nodes_[find_leaf(details::kd_coordinates(f))].group;
+  }
+
+  std::vector<FeatureType> boundary(const GroupKey &x,
+                                    const GroupKey &y) const {
+    const auto &a = nodes_[leaves_[x]];
+    const auto &b = nodes_[leaves_[y]];
+    const Eigen::Index dimension = a.lower.size();
+
+    // Two cells share a boundary if they touch along exactly one split
+    // plane and overlap in all the other dimensions.
+    Eigen::Index touching_dimension = -1;
+    for (Eigen::Index d = 0; d < dimension; ++d) {
+      const bool touching =
+          a.upper[d] == b.lower[d] || b.upper[d] == a.lower[d];
+      const double lo = std::max(a.lower[d], b.lower[d]);
+      const double hi = std::min(a.upper[d], b.upper[d]);
+      const bool degenerate = nodes_[0].lower[d] == nodes_[0].upper[d];
+      if (touching && !degenerate) {
+        if (touching_dimension >= 0) {
+          // Cells which only meet at an edge or corner.
+          return {};
+        }
+        touching_dimension = d;
+      } else if (hi < lo || (hi == lo && !degenerate)) {
+        return {};
+      }
+    }
+
+    if (touching_dimension < 0) {
+      return {};
+    }
+
+    // Lay out a grid of boundary features on the shared face.
+    std::vector<Eigen::VectorXd> grid = {Eigen::VectorXd(dimension)};
+    for (Eigen::Index d = 0; d < dimension; ++d) {
+      std::vector<double> values;
+      if (d == touching_dimension) {
+        values.push_back(a.upper[d] == b.lower[d] ? a.upper[d] : a.lower[d]);
+      } else {
+        const double lo = std::max(a.lower[d], b.lower[d]);
+        const double hi = std::min(a.upper[d], b.upper[d]);
+        const std::size_t n = std::max(
+            std::size_t(1),
+            static_cast<std::size_t>(std::ceil((hi - lo) / boundary_spacing_)));
+        const double step = (hi - lo) / static_cast<double>(n);
+        for (std::size_t i = 0; i < n; ++i) {
+          values.push_back(lo + (static_cast<double>(i) + 0.5) * step);
+        }
+      }
+
+      std::vector<Eigen::VectorXd> next_grid;
+      for (const auto &point : grid) {
+        for (const auto &v : values) {
+          Eigen::VectorXd next_point(point);
+          next_point[d] = v;
+          next_grid.emplace_back(next_point);
+        }
+      }
+      grid = std::move(next_grid);
+    }
+
+    std::vector<FeatureType> output;
+    for (const auto &point : grid) {
+      output.emplace_back(
+          details::KDFeatureFromCoordinates<FeatureType>::create(point));
+    }
+    return output;
+  }
+
+  /*
+   * Walks up the partition tree from the query's cell until reaching
+   * a node which contains one of the available groups, then picks
+   * the available group in that subtree with the closest cell.
+   */
+  GroupKey nearest_group(const std::vector<GroupKey> &groups,
+                         const GroupKey &query) const {
+    assert(groups.size() > 0);
+    if (std::find(groups.begin(), groups.end(), query) != groups.end()) {
+      return query;
+    }
+
+    const auto &query_node = nodes_[leaves_[query]];
+    const Eigen::VectorXd query_center =
+        0.5 * (query_node.lower + query_node.upper);
+
+    int ancestor = query_node.parent;
+    while (ancestor >= 0) {
+      const std::size_t ancestor_index = static_cast<std::size_t>(ancestor);
+      GroupKey nearest = query;
+      double nearest_distance = std::numeric_limits<double>::max();
+      for (const auto &group : groups) {
+        if (is_descendant(leaves_[group], ancestor_index)) {
+          const auto &node = nodes_[leaves_[group]];
+          const double distance =
+              (0.5 * (node.lower + node.upper) - query_center).norm();
+          if (distance < nearest_distance) {
+            nearest = group;
+            nearest_distance = distance;
+          }
+        }
+      }
+      if (nearest_distance < std::numeric_limits<double>::max()) {
+        return nearest;
+      }
+      ancestor = nodes_[ancestor_index].parent;
+    }
+    return groups[0];
+  }
+
+  std::size_t number_of_groups() const { return leaves_.size(); }
+
+private:
+  int build(const std::vector<Eigen::VectorXd> &points,
+            std::vector<std::size_t> *inds, std::size_t begin, std::size_t end,
+            std::size_t max_patch_size, int parent,
+            const Eigen::VectorXd &lower, const Eigen::VectorXd &upper) {
+
+    const int index = static_cast<int>(nodes_.size());
+    details::KDPartitionNode node;
+    node.parent = parent;
+    node.left = -1;
+    node.right = -1;
+    node.depth =
+        parent < 0 ? 0 : nodes_[static_cast<std::size_t>(parent)].depth + 1;
+    node.split_dimension = 0;
+    node.split_value = 0.;
+    node.lower = lower;
+    node.upper = upper;
+    node.group = 0;
+    nodes_.push_back(node);
+
+    // Split along the dimension with the largest spread.
+    Eigen::VectorXd min_value = points[(*inds)[begin]];
+    Eigen::VectorXd max_value = points[(*inds)[begin]];
+    for (std::size_t i = begin; i < end; ++i) {
+      min_value = min_value.cwiseMin(points[(*inds)[i]]);
+      max_value = max_value.cwiseMax(points[(*inds)[i]]);
+    }
+    Eigen::Index split_dimension;
+    const double spread = (max_value - min_value).maxCoeff(&split_dimension);
+
+    if (end - begin <= max_patch_size || spread <= 0.) {
+      nodes_[static_cast<std::size_t>(index)].group = leaves_.size();
+      leaves_.push_back(static_cast<std::size_t>(index));
+      return index;
+    }
+
+    // The split has to send each point to the same side that find_leaf
+    // will, so with repeated coordinates it's placed strictly between the
+    // median value and whichever neighbouring distinct value gives the
+    // more balanced split.
+    const auto first = inds->begin() + static_cast<std::ptrdiff_t>(begin);
+    const auto last = inds->begin() + static_cast<std::ptrdiff_t>(end);
+    const std::size_t count = end - begin;
+    auto compare = [&](const std::size_t &i, const std::size_t &j) {
+      return points[i][split_dimension] < points[j][split_dimension];
+    };
+    std::nth_element(first, first + static_cast<std::ptrdiff_t>(count / 2),
+                     last, compare);
+    const double median = points[*(first + static_cast<std::ptrdiff_t>(
+                                           count / 2))][split_dimension];
+
+    double below = std::numeric_limits<double>::lowest();
+    double above = std::numeric_limits<double>::max();
+    std::size_t count_below = 0;
+    std::size_t count_above = 0;
+    for (auto it = first; it != last; ++it) {
+      const double value = points[*it][split_dimension];
+      if (value < median) {
+        below = std::max(below, value);
+        ++count_below;
+      } else if (value > median) {
+        above = std::min(above, value);
+        ++count_above;
+      }
+    }
+
+    const auto imbalance = [&](std::size_t left_count) {
+      return left_count > count / 2 ? left_count - count / 2
+                                    : count / 2 - left_count;
+    };
+    const auto between = [](double lo, double hi) {
+      const double mid = 0.5 * (lo + hi);
+      return mid > lo ? mid : hi;
+    };
+    // Since the spread is positive at least one of the candidates exists.
+    double split_value;
+    if (count_above == 0 ||
+        (count_below > 0 &&
+         imbalance(count_below) <= imbalance(count - count_above))) {
+      split_value = between(below, median);
+    } else {
+      split_value = between(median, above);
+    }
+
+    const auto split = std::partition(first, last, [&](const std::size_t &i) {
+      return points[i][split_dimension] < split_value;
+    });
+    const std::size_t middle =
+        begin + static_cast<std::size_t>(std::distance(first, split));
+    assert(middle > begin && middle < end);
+
+    Eigen::VectorXd left_upper(upper);
+    left_upper[split_dimension] = split_value;
+    Eigen::VectorXd right_lower(lower);
+    right_lower[split_dimension] = split_value;
+
+    const int left = build(points, inds, begin, middle, max_patch_size, index,
+                           lower, left_upper);
+    const int right = build(points, inds, middle, end, max_patch_size, index,
+                            right_lower, upper);
+
+    auto &built = nodes_[static_cast<std::size_t>(index)];
+    built.split_dimension = split_dimension;
+    built.split_value = split_value;
+    built.left = left;
+    built.right = right;
+    return index;
+  }
+
+  std::size_t find_leaf(const Eigen::VectorXd &x) const {
+    std::size_t index = 0;
+    while (!nodes_[index].is_leaf()) {
+      const auto &node = nodes_[index];
+      index = static_cast<std::size_t>(
+          x[node.split_dimension] < node.split_value ? node.left : node.right);
+    }
+    return index;
+  }
+
+  bool is_descendant(std::size_t node, std::size_t ancestor) const {
+    while (nodes_[node].depth > nodes_[ancestor].depth) {
+      node = static_cast<std::size_t>(nodes_[node].parent);
+    }
+    return node == ancestor;
+  }
+
+  std::vector<details::KDPartitionNode> nodes_;
+  // Maps from group key to the corresponding leaf node.
+  std::vector<std::size_t> leaves_;
+  double boundary_spacing_;
+};
+
+template <typename FeatureType>
+inline KDPartitionPatchworkFunctions<FeatureType>
+kd_partition_patchwork_functions(const std::vector<FeatureType> &features,
+                                 std::size_t max_patch_size,
+                                 double boundary_spacing) {
+  return KDPartitionPatchworkFunctions<FeatureType>(features, max_patch_size,
+                                                    boundary_spacing);
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_MODELS_PATCHWORK_PARTITION_H_ */
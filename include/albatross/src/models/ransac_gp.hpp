@@ -149,6 +149,11 @@ struct AlwaysAcceptCandidateMetric {
   }
 };
 
+/*
+ * Builds the RANSAC functions from the (prior) covariance between all
+ * the features in the dataset, which may have been sliced out of a
+ * larger covariance that's being reused.
+ */
 template <typename ModelType, typename FeatureType, typename InlierMetric,
           typename ConsensusMetric, typename IsValidCandidateMetric,
           typename GroupKey>
@@ -156,8 +161,8 @@ inline RansacFunctions<FitAndIndices<ModelType, FeatureType>, GroupKey>
 get_gp_ransac_functions(
     const ModelType &model,
     const RegressionDataset<FeatureType> &dataset_with_mean,
-    const GroupIndexer<GroupKey> &indexer, const InlierMetric &inlier_metric,
-    const ConsensusMetric &consensus_metric,
+    const GroupIndexer<GroupKey> &indexer, const Eigen::MatrixXd &full_cov,
+    const InlierMetric &inlier_metric, const ConsensusMetric &consensus_metric,
     const IsValidCandidateMetric &is_valid_candidate_metric) {
 
   static_assert(is_prediction_metric<InlierMetric>::value,
@@ -165,7 +170,6 @@ get_gp_ransac_functions(
 
   RegressionDataset<FeatureType> dataset(dataset_with_mean);
   model.get_mean().remove_from(dataset.features, &dataset.targets.mean);
-  const auto full_cov = model.compute_covariance(dataset.features);
 
   const auto fitter = get_gp_ransac_fitter<ModelType, FeatureType, GroupKey>(
       dataset, indexer, full_cov);
@@ -189,6 +193,22 @@ get_gp_ransac_functions(
       is_valid_candidate);
 };
 
+template <typename ModelType, typename FeatureType, typename InlierMetric,
+          typename ConsensusMetric, typename IsValidCandidateMetric,
+          typename GroupKey>
+inline RansacFunctions<FitAndIndices<ModelType, FeatureType>, GroupKey>
+get_gp_ransac_functions(
+    const ModelType &model,
+    const RegressionDataset<FeatureType> &dataset_with_mean,
+    const GroupIndexer<GroupKey> &indexer, const InlierMetric &inlier_metric,
+    const ConsensusMetric &consensus_metric,
+    const IsValidCandidateMetric &is_valid_candidate_metric) {
+  const auto full_cov = model.compute_covariance(dataset_with_mean.features);
+  return get_gp_ransac_functions(model, dataset_with_mean, indexer, full_cov,
+                                 inlier_metric, consensus_metric,
+                                 is_valid_candidate_metric);
+};
+
 template <typename InlierMetric, typename ConsensusMetric,
           typename IsValidCandidateMetric, typename GrouperFunction>
 struct GaussianProcessRansacStrategy {
@@ -212,6 +232,18 @@ struct GaussianProcessRansacStrategy {
                                    consensus_metric_, is_valid_candidate_);
   }
 
+  // The same as above but the functions slice the provided covariance
+  // between all the features in `dataset` instead of computing it.
+  template <typename ModelType, typename FeatureType>
+  auto operator()(const ModelType &model,
+                  const RegressionDataset<FeatureType> &dataset,
+                  const Eigen::MatrixXd &full_cov) const {
+    const auto indexer = get_indexer(dataset);
+    return get_gp_ransac_functions(model, dataset, indexer, full_cov,
+                                   inlier_metric_, consensus_metric_,
+                                   is_valid_candidate_);
+  }
+
   template <typename FeatureType>
   auto get_indexer(const RegressionDataset<FeatureType> &dataset) const {
     return dataset.group_by(grouper_function_).indexers();
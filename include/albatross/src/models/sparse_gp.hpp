@@ -290,6 +290,24 @@ public:
     }
   }
 
+  /*
+   * When updating a fit the information from previous data is down
+   * weighted by the forgetting factor, lambda, so a fit which has seen
+   * a stream of batches y_1, ..., y_k has a posterior over the inducing
+   * points with precision,
+   *
+   *   K_uu + sum_j lambda^(k - j) K_uj A_j^-1 K_ju
+   *
+   * Only the data is forgotten, so regions that haven't seen data in a
+   * while revert to the prior.  The default of one disables forgetting.
+   */
+  void set_forgetting_factor(double forgetting_factor) {
+    assert(forgetting_factor > 0. && forgetting_factor <= 1.);
+    forgetting_factor_ = forgetting_factor;
+  }
+
+  double get_forgetting_factor() const { return forgetting_factor_; }
+
   template <typename FeatureType, typename InducingPointFeatureType>
   auto _update_impl(const Fit<SparseGPFit<InducingPointFeatureType>> &old_fit,
                     const std::vector<FeatureType> &features,
@@ -305,25 +323,37 @@ public:
     const Eigen::Index n_old = old_fit.sigma_R.rows();
     const Eigen::Index n_new = A_ldlt.rows();
     const Eigen::Index k = old_fit.sigma_R.cols();
-    Eigen::MatrixXd B = Eigen::MatrixXd::Zero(n_old + n_new, k);
+    // With forgetting, the old square root information is scaled by
+    // sqrt(lambda) which also scales the prior it contains, so the
+    // remaining (1 - lambda) of the prior is added back in.
+    const double lambda = forgetting_factor_;
+    const Eigen::Index n_prior = lambda < 1. ? k : 0;
+    Eigen::MatrixXd B = Eigen::MatrixXd::Zero(n_old + n_new + n_prior, k);
 
     assert(n_old == k);
 
     // Form:
-    //   B = |R_old P_old^T| = |Q_1| R P^T
-    //       |A^{-1/2} K_fu|   |Q_2|
+    //   B = |sqrt(lambda) R_old P_old^T | = |Q_1| R P^T
+    //       |A^{-1/2} K_fu              |   |Q_2|
+    //       |sqrt(1 - lambda) K_uu^{T/2}|   |Q_3|
     for (Eigen::Index i = 0; i < old_fit.permutation_indices.size(); ++i) {
       const Eigen::Index &pi = old_fit.permutation_indices.coeff(i);
       B.col(pi).topRows(i + 1) = old_fit.sigma_R.col(i).topRows(i + 1);
     }
-    B.bottomRows(n_new) = A_ldlt.sqrt_solve(K_fu);
+    B.middleRows(n_old, n_new) = A_ldlt.sqrt_solve(K_fu);
+    if (n_prior > 0) {
+      B.topRows(n_old) *= sqrt(lambda);
+      B.bottomRows(n_prior) = sqrt(1. - lambda) * K_uu_ldlt.sqrt_transpose();
+    }
     const auto B_qr = B.colPivHouseholderQr();
 
     // Form:
-    //   y_aug = |R_old P_old^T v_old|
-    //           |A^{-1/2} y         |
+    //   y_aug = |sqrt(lambda) R_old P_old^T v_old|
+    //           |A^{-1/2} y                      |
+    //           |0                               |
     assert(old_fit.information.size() == n_old);
-    Eigen::VectorXd y_augmented(n_old + n_new);
+    Eigen::VectorXd y_augmented =
+        Eigen::VectorXd::Zero(n_old + n_new + n_prior);
     for (Eigen::Index i = 0; i < old_fit.permutation_indices.size(); ++i) {
       y_augmented[i] =
           old_fit.information[old_fit.permutation_indices.coeff(i)];
@@ -331,11 +361,12 @@ public:
     y_augmented.topRows(n_old) =
         old_fit.sigma_R.template triangularView<Eigen::Upper>() *
         y_augmented.topRows(n_old);
+    y_augmented.topRows(n_old) *= sqrt(lambda);
 
     if (Base::use_async_) {
-      y_augmented.bottomRows(n_new) = A_ldlt.async_sqrt_solve(y);
+      y_augmented.middleRows(n_old, n_new) = A_ldlt.async_sqrt_solve(y);
     } else {
-      y_augmented.bottomRows(n_new) = A_ldlt.sqrt_solve(y);
+      y_augmented.middleRows(n_old, n_new) = A_ldlt.sqrt_solve(y);
     }
     const Eigen::VectorXd v = B_qr.solve(y_augmented);
 
@@ -600,6 +631,23 @@ public:
            this->prior_log_likelihood();
   }
 
+  /*
+   * Records the distribution of block sizes in A_ff which would result
+   * from fitting to these features.  Since the cost of the fit is
+   * dominated by the largest blocks this is useful when tuning the
+   * independent group function.
+   */
+  template <typename FeatureType>
+  void record_block_size_insights(const std::vector<FeatureType> &features) {
+    const auto indexer = details::independent_group_indexers(
+        independent_group_function_, features);
+    const auto histogram = block_size_histogram(indexer);
+    this->insights["independent_group_block_sizes"] =
+        block_size_histogram_to_string(histogram);
+    this->insights["max_independent_group_block_size"] =
+        histogram.empty() ? "0" : std::to_string(histogram.rbegin()->first);
+  }
+
 private:
   // This method takes care of a lot of the common book keeping required to
   // setup the Sparse Gaussian Process problem.  Namely, we want to get from
@@ -620,8 +668,8 @@ private:
     assert(K_fu != nullptr);
     assert(y != nullptr);
 
-    const auto indexer =
-        group_by(out_of_order_features, independent_group_function_).indexers();
+    const auto indexer = details::independent_group_indexers(
+        independent_group_function_, out_of_order_features);
 
     const auto out_of_order_measurement_features =
         as_measurements(out_of_order_features);
@@ -686,6 +734,7 @@ private:
   Parameter inducing_nugget_;
   InducingPointStrategy inducing_point_strategy_;
   GrouperFunction independent_group_function_;
+  double forgetting_factor_ = 1.;
 };
 
 // rebase_inducing_points takes a Sparse GP which was fit using some set of
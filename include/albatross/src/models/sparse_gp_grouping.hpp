@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_MODELS_SPARSE_GP_GROUPING_H_
+#define INCLUDE_ALBATROSS_MODELS_SPARSE_GP_GROUPING_H_
+
+/*
+ * The Sparse Gaussian Process factorizes a block diagonal matrix with one
+ * block per independent group, so the cost scales with the sum of the cubes
+ * of the block sizes.  A few very large groups can dominate both the run
+ * time and memory while lots of tiny groups add per block overhead.
+ *
+ * SizeCappedGrouper wraps an existing grouper function and rebalances the
+ * groups it produces: groups larger than `max_block_size` are split into
+ * balanced contiguous sub groups (contiguous with respect to an optional
+ * ordering such as time or distance along a track) and groups smaller than
+ * `min_block_size` are merged together.
+ */
+
+namespace albatross {
+
+namespace details {
+
+DEFINE_CLASS_METHOD_TRAITS(indexers);
+
+/*
+ * Indicates that the features within a group should be left in the order
+ * they were provided when splitting large groups.
+ */
+struct InputOrder {};
+
+template <typename FeatureType>
+inline void sort_group_indices(const std::vector<FeatureType> &features,
+                               const InputOrder &, GroupIndices *indices) {}
+
+template <typename FeatureType, typename OrderFunction>
+inline void sort_group_indices(const std::vector<FeatureType> &features,
+                               const OrderFunction &order,
+                               GroupIndices *indices) {
+  std::stable_sort(indices->begin(), indices->end(),
+                   [&](const std::size_t &i, const std::size_t &j) {
+                     return order(features[i]) < order(features[j]);
+                   });
+}
+
+template <typename GrouperFunction, typename FeatureType,
+          typename std::enable_if<
+              has_indexers<const GrouperFunction,
+                           const std::vector<FeatureType> &>::value,
+              int>::type = 0>
+inline auto
+independent_group_indexers(const GrouperFunction &grouper,
+                           const std::vector<FeatureType> &features) {
+  return grouper.indexers(features);
+}
+
+template <typename GrouperFunction, typename FeatureType,
+          typename std::enable_if<
+              !has_indexers<const GrouperFunction,
+                            const std::vector<FeatureType> &>::value,
+              int>::type = 0>
+inline auto
+independent_group_indexers(const GrouperFunction &grouper,
+                           const std::vector<FeatureType> &features) {
+  return group_by(features, grouper).indexers();
+}
+
+} // namespace details
+
+template <typename GrouperFunction,
+          typename OrderFunction = details::InputOrder>
+class SizeCappedGrouper {
+
+public:
+  SizeCappedGrouper()
+      : grouper_(), order_(), max_block_size_(0), min_block_size_(0){};
+
+  SizeCappedGrouper(const GrouperFunction &grouper, std::size_t max_block_size,
+                    std::size_t min_block_size = 1,
+                    const OrderFunction &order = OrderFunction())
+      : grouper_(grouper), order_(order), max_block_size_(max_block_size),
+        min_block_size_(min_block_size) {
+    assert(max_block_size_ > 0);
+    assert(min_block_size_ <= max_block_size_);
+  };
+
+  /*
+   * Builds the rebalanced groups, the resulting keys are simply the
+   * index of each block.
+   */
+  template <typename FeatureType>
+  GroupIndexer<std::size_t>
+  indexers(const std::vector<FeatureType> &features) const {
+    const auto original =
+        details::independent_group_indexers(grouper_, features);
+
+    GroupIndexer<std::size_t> output;
+    auto add_block = [&](GroupIndices &&indices) {
+      const std::size_t key = output.size();
+      output.emplace(key, std::move(indices));
+    };
+
+    GroupIndices merged;
+    for (const auto &pair : original) {
+      GroupIndices indices = pair.second;
+      const std::size_t n = indices.size();
+
+      if (n < min_block_size_) {
+        if (merged.size() + n > max_block_size_) {
+          add_block(std::move(merged));
+          merged = GroupIndices();
+        }
+        merged.insert(merged.end(), indices.begin(), indices.end());
+        if (merged.size() >= min_block_size_) {
+          add_block(std::move(merged));
+          merged = GroupIndices();
+        }
+      } else if (n <= max_block_size_) {
+        add_block(std::move(indices));
+      } else {
+        details::sort_group_indices(features, order_, &indices);
+        // Split into the fewest number of blocks which satisfy the cap
+        // and spread the remainder so block sizes differ by at most one.
+        const std::size_t num_blocks =
+            (n + max_block_size_ - 1) / max_block_size_;
+        const std::size_t base_size = n / num_blocks;
+        const std::size_t remainder = n % num_blocks;
+        auto begin = indices.begin();
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+          const std::size_t size = base_size + (i < remainder ? 1 : 0);
+          const auto end = begin + static_cast<std::ptrdiff_t>(size);
+          add_block(GroupIndices(begin, end));
+          begin = end;
+        }
+      }
+    }
+
+    if (!merged.empty()) {
+      add_block(std::move(merged));
+    }
+
+    return output;
+  }
+
+  std::size_t max_block_size() const { return max_block_size_; }
+
+  std::size_t min_block_size() const { return min_block_size_; }
+
+private:
+  GrouperFunction grouper_;
+  OrderFunction order_;
+  std::size_t max_block_size_;
+  std::size_t min_block_size_;
+};
+
+template <typename GrouperFunction>
+inline auto size_capped_grouper(GrouperFunction &&grouper,
+                                std::size_t max_block_size,
+                                std::size_t min_block_size = 1) {
+  return SizeCappedGrouper<typename std::decay<GrouperFunction>::type>(
+      std::forward<GrouperFunction>(grouper), max_block_size, min_block_size);
+}
+
+template <typename GrouperFunction, typename OrderFunction>
+inline auto size_capped_grouper(GrouperFunction &&grouper,
+                                std::size_t max_block_size,
+                                std::size_t min_block_size,
+                                OrderFunction &&order) {
+  return SizeCappedGrouper<typename std::decay<GrouperFunction>::type,
+                           typename std::decay<OrderFunction>::type>(
+      std::forward<GrouperFunction>(grouper), max_block_size, min_block_size,
+      std::forward<OrderFunction>(order));
+}
+
+/*
+ * Maps from block size to the number of blocks of that size.
+ */
+template <typename GroupKey>
+inline std::map<std::size_t, std::size_t>
+block_size_histogram(const GroupIndexer<GroupKey> &indexer) {
+  std::map<std::size_t, std::size_t> histogram;
+  for (const auto &pair : indexer) {
+    histogram[pair.second.size()] += 1;
+  }
+  return histogram;
+}
+
+inline std::string
+block_size_histogram_to_string(const std::map<std::size_t, std::size_t> &hist) {
+  std::ostringstream oss;
+  bool first = true;
+  for (const auto &pair : hist) {
+    if (!first) {
+      oss << ", ";
+    }
+    oss << pair.first << ":" << pair.second;
+    first = false;
+  }
+  return oss.str();
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_MODELS_SPARSE_GP_GROUPING_H_ */
@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_MODELS_SPATIO_TEMPORAL_GP_H_
+#define INCLUDE_ALBATROSS_MODELS_SPATIO_TEMPORAL_GP_H_
+
+/*
+ * A Gaussian process over space and time with a separable covariance,
+ *
+ *   cov(f(t, s), f(t', s')) = corr(t, t') * cov(s, s')
+ *
+ * where the temporal correlation is Markovian, which lets the process be
+ * written as a linear state space model,
+ *
+ *   x_k = (F(t_k - t_{k-1}) (x) I) x_{k-1} + w_k
+ *   w_k ~ N(0, Q(t_k - t_{k-1}) (x) K_uu)
+ *
+ * with (x) the Kronecker product.  The state, x, holds the temporal state
+ * of the process at a fixed set of spatial "state features", u, which
+ * for a network of stations would typically be the stations themselves
+ * (see DistinctSpatialFeatures).  An observation at (t, s) is then
+ *
+ *   y = K_su K_uu^-1 x_0(t) + e
+ *
+ * where x_0 is the first component of the temporal state (the process
+ * itself) and e is independent noise.  If s is not one of the state
+ * features, the spatial variance it has which isn't explained by the
+ * state features is treated as independent noise, similar to the FITC
+ * approximation in sparse_gp.hpp.  Similarly any part of the spatial
+ * covariance function which only applies to Measurement<> features
+ * (see measurement_only) is treated as measurement noise.
+ *
+ * Fitting runs a Kalman filter through the epochs (the distinct times
+ * in the training data) which costs O(T (d m)^3) for T epochs, m state
+ * features and a temporal state of dimension d, instead of O((T m)^3)
+ * for a direct Gaussian process.  Updating a fit with later epochs
+ * continues the filter, and predictions use a Rauch-Tung-Striebel
+ * smoother which only needs to go back as far as the earliest time
+ * being predicted.  Since the smoother doesn't keep track of the
+ * covariance between times only marginal predictions are available.
+ *
+ * Note that the state features are chosen by the initial fit and kept
+ * for all subsequent updates.
+ */
+
+namespace albatross {
+
+constexpr double default_temporal_length_scale = 1.;
+
+template <typename SpatialFeatureType> struct SpaceTimeFeature {
+
+  SpaceTimeFeature() : time(0.), space(){};
+
+  SpaceTimeFeature(double time_, const SpatialFeatureType &space_)
+      : time(time_), space(space_){};
+
+  bool operator==(const SpaceTimeFeature &other) const {
+    return time == other.time && space == other.space;
+  }
+
+  double time;
+  SpatialFeatureType space;
+};
+
+/*
+ * A temporal process describes a stationary correlation in time through
+ * its state space representation,
+ *
+ *   corr(t, t') = [F(|t - t'|) P](0, 0)
+ *
+ * and needs to provide:
+ *
+ *   Eigen::Index state_dimension() const;
+ *   Eigen::MatrixXd transition(double dt) const;    // F(dt)
+ *   Eigen::MatrixXd stationary_covariance() const;  // P
+ *
+ * where the first element of the state is the process itself.
+ */
+
+/*
+ * The Matern 1/2 (or Ornstein-Uhlenbeck) process,
+ *
+ *   corr(dt) = exp(-|dt|/length_scale)
+ */
+class ExponentialTemporalProcess : public ParameterHandlingMixin {
+public:
+  ALBATROSS_DECLARE_PARAMS(exponential_temporal_length_scale);
+
+  ExponentialTemporalProcess(
+      double length_scale = default_temporal_length_scale) {
+    exponential_temporal_length_scale = {length_scale, PositivePrior()};
+  };
+
+  std::string get_name() const { return "exponential_temporal"; }
+
+  Eigen::Index state_dimension() const { return 1; }
+
+  Eigen::MatrixXd transition(double dt) const {
+    assert(dt >= 0.);
+    return Eigen::MatrixXd::Constant(
+        1, 1, exp(-dt / exponential_temporal_length_scale.value));
+  }
+
+  Eigen::MatrixXd stationary_covariance() const {
+    return Eigen::MatrixXd::Identity(1, 1);
+  }
+};
+
+/*
+ * The Matern 3/2 process which has a state made up of the process
+ * and its derivative,
+ *
+ *   corr(dt) = (1 + sqrt(3) |dt| / length_scale) *
+ *                  exp(-sqrt(3) |dt| / length_scale)
+ */
+class Matern32TemporalProcess : public ParameterHandlingMixin {
+public:
+  ALBATROSS_DECLARE_PARAMS(matern_32_temporal_length_scale);
+
+  Matern32TemporalProcess(double length_scale = default_temporal_length_scale) {
+    matern_32_temporal_length_scale = {length_scale, PositivePrior()};
+  };
+
+  std::string get_name() const { return "matern_32_temporal"; }
+
+  Eigen::Index state_dimension() const { return 2; }
+
+  Eigen::MatrixXd transition(double dt) const {
+    assert(dt >= 0.);
+    const double lambda = sqrt(3.) / matern_32_temporal_length_scale.value;
+    const double decay = exp(-lambda * dt);
+    Eigen::MatrixXd F(2, 2);
+    F << (1. + lambda * dt) * decay, dt * decay,
+        -lambda * lambda * dt * decay, (1. - lambda * dt) * decay;
+    return F;
+  }
+
+  Eigen::MatrixXd stationary_covariance() const {
+    const double lambda = sqrt(3.) / matern_32_temporal_length_scale.value;
+    Eigen::MatrixXd P = Eigen::MatrixXd::Zero(2, 2);
+    P(0, 0) = 1.;
+    P(1, 1) = lambda * lambda;
+    return P;
+  }
+};
+
+template <typename TemporalProcess>
+inline double temporal_correlation(const TemporalProcess &process,
+                                   double dt) {
+  const Eigen::MatrixXd FP =
+      process.transition(fabs(dt)) * process.stationary_covariance();
+  return FP(0, 0);
+}
+
+/*
+ * Uses each of the distinct spatial features in the training data as
+ * a state feature, which is exact for observations from a fixed
+ * network of stations.
+ */
+struct DistinctSpatialFeatures {
+
+  template <typename CovFunc, typename FeatureType>
+  std::vector<FeatureType>
+  operator()(const CovFunc &, const std::vector<FeatureType> &features) const {
+    std::vector<FeatureType> distinct;
+    for (const auto &f : features) {
+      if (std::find(distinct.begin(), distinct.end(), f) == distinct.end()) {
+        distinct.push_back(f);
+      }
+    }
+    return distinct;
+  }
+};
+
+template <typename StateFeatureType> struct SpatioTemporalGPFit {};
+
+template <typename StateFeatureType>
+struct Fit<SpatioTemporalGPFit<StateFeatureType>> {
+
+  std::vector<StateFeatureType> state_features;
+  // The spatial prior covariance of the state features, K_uu.
+  Eigen::SerializableLDLT state_covariance;
+  // The filtered distribution of the state at each epoch.
+  std::vector<double> times;
+  std::vector<Eigen::VectorXd> means;
+  std::vector<Eigen::MatrixXd> covariances;
+
+  Fit(){};
+
+  Fit(const std::vector<StateFeatureType> &state_features_,
+      const Eigen::SerializableLDLT &state_covariance_)
+      : state_features(state_features_), state_covariance(state_covariance_),
+        times(), means(), covariances(){};
+
+  bool operator==(const Fit &other) const {
+    return (state_features == other.state_features &&
+            state_covariance == other.state_covariance &&
+            times == other.times && means == other.means &&
+            covariances == other.covariances);
+  }
+};
+
+namespace details {
+
+// Keeps the spatial covariance of the state features invertible, for
+// example when two of them are very close.
+constexpr double default_state_nugget = 1e-8;
+
+inline Eigen::MatrixXd kronecker_product(const Eigen::MatrixXd &A,
+                                         const Eigen::MatrixXd &B) {
+  Eigen::MatrixXd output(A.rows() * B.rows(), A.cols() * B.cols());
+  for (Eigen::Index i = 0; i < A.rows(); ++i) {
+    for (Eigen::Index j = 0; j < A.cols(); ++j) {
+      output.block(i * B.rows(), j * B.cols(), B.rows(), B.cols()) =
+          A(i, j) * B;
+    }
+  }
+  return output;
+}
+
+struct StateDistribution {
+  Eigen::VectorXd mean;
+  Eigen::MatrixXd covariance;
+};
+
+} // namespace details
+
+template <typename CovFunc, typename TemporalProcess,
+          typename StateFeatureStrategy = DistinctSpatialFeatures>
+class SpatioTemporalGaussianProcess
+    : public ModelBase<SpatioTemporalGaussianProcess<CovFunc, TemporalProcess,
+                                                     StateFeatureStrategy>> {
+
+public:
+  SpatioTemporalGaussianProcess()
+      : covariance_function_(), temporal_process_(),
+        state_feature_strategy_(){};
+
+  SpatioTemporalGaussianProcess(
+      const CovFunc &covariance_function,
+      const TemporalProcess &temporal_process,
+      const StateFeatureStrategy &state_feature_strategy =
+          StateFeatureStrategy())
+      : covariance_function_(covariance_function),
+        temporal_process_(temporal_process),
+        state_feature_strategy_(state_feature_strategy){};
+
+  std::string get_name() const {
+    return "spatio_temporal[" + covariance_function_.get_name() + "," +
+           temporal_process_.get_name() + "]";
+  }
+
+  ParameterStore get_params() const override {
+    return map_join(covariance_function_.get_params(),
+                    temporal_process_.get_params());
+  }
+
+  void unchecked_set_param(const ParameterKey &name,
+                           const Parameter &param) override {
+    if (map_contains(covariance_function_.get_params(), name)) {
+      covariance_function_.set_param(name, param);
+    } else if (map_contains(temporal_process_.get_params(), name)) {
+      temporal_process_.set_param(name, param);
+    } else {
+      std::cerr << "Unknown param: " << name << std::endl;
+      assert(false);
+    }
+  }
+
+  bool operator==(const SpatioTemporalGaussianProcess &other) const {
+    return get_params() == other.get_params();
+  }
+
+  template <typename SpatialFeatureType>
+  auto _fit_impl(
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features,
+      const MarginalDistribution &targets) const {
+    auto fit = unfiltered_fit(features);
+    filter(features, targets, &fit);
+    return fit;
+  }
+
+  /*
+   * Continues filtering through later epochs, which must not precede
+   * the last epoch already in the fit.
+   */
+  template <typename SpatialFeatureType, typename StateFeatureType>
+  void _update_in_place_impl(
+      Fit<SpatioTemporalGPFit<StateFeatureType>> *fit,
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features,
+      const MarginalDistribution &targets) const {
+    filter(features, targets, fit);
+  }
+
+  template <typename SpatialFeatureType, typename StateFeatureType>
+  auto _update_impl(
+      const Fit<SpatioTemporalGPFit<StateFeatureType>> &old_fit,
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features,
+      const MarginalDistribution &targets) const {
+    auto fit = old_fit;
+    filter(features, targets, &fit);
+    return fit;
+  }
+
+  template <typename SpatialFeatureType, typename StateFeatureType>
+  MarginalDistribution _predict_impl(
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features,
+      const Fit<SpatioTemporalGPFit<StateFeatureType>> &fit,
+      PredictTypeIdentity<MarginalDistribution> &&) const {
+
+    auto get_time = [](const auto &f) { return f.time; };
+    const auto epochs = group_by(features, get_time).indexers();
+
+    std::vector<double> times;
+    for (const auto &pair : epochs) {
+      times.push_back(pair.first);
+    }
+    const auto states = smoothed_states(fit, times);
+
+    Eigen::VectorXd mean(static_cast<Eigen::Index>(features.size()));
+    Eigen::VectorXd variance(static_cast<Eigen::Index>(features.size()));
+    std::size_t i = 0;
+    for (const auto &pair : epochs) {
+      const auto spatial_features =
+          get_spatial_features(subset(features, pair.second));
+      Eigen::VectorXd unexplained;
+      const Eigen::MatrixXd H =
+          observation_matrix(fit, spatial_features, &unexplained);
+
+      const auto &state = states[i];
+      const Eigen::Index m = H.cols();
+      const Eigen::MatrixXd HP = H * state.covariance.topLeftCorner(m, m);
+      const Eigen::VectorXd epoch_mean = H * state.mean.head(m);
+      const Eigen::VectorXd epoch_variance =
+          HP.cwiseProduct(H).rowwise().sum() + unexplained;
+
+      set_subset(epoch_mean, pair.second, &mean);
+      set_subset(epoch_variance, pair.second, &variance);
+      ++i;
+    }
+    return MarginalDistribution(mean, variance);
+  }
+
+  /*
+   * The log likelihood of the data computed from the innovations of the
+   * Kalman filter.
+   */
+  template <typename SpatialFeatureType>
+  double log_likelihood(
+      const RegressionDataset<SpaceTimeFeature<SpatialFeatureType>> &dataset)
+      const {
+    auto fit = unfiltered_fit(dataset.features);
+    return filter(dataset.features, dataset.targets, &fit) +
+           this->prior_log_likelihood();
+  }
+
+  CovFunc get_covariance() const { return covariance_function_; }
+
+  TemporalProcess get_temporal_process() const { return temporal_process_; }
+
+private:
+  template <typename SpatialFeatureType>
+  auto unfiltered_fit(
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features)
+      const {
+    const auto state_features = state_feature_strategy_(
+        covariance_function_, get_spatial_features(features));
+    assert(state_features.size() > 0 && "Empty state features!");
+
+    using StateFeatureType =
+        typename std::decay<decltype(state_features[0])>::type;
+    using FitType = Fit<SpatioTemporalGPFit<StateFeatureType>>;
+
+    Eigen::MatrixXd K_uu = covariance_function_(state_features);
+    K_uu.diagonal() +=
+        details::default_state_nugget * Eigen::VectorXd::Ones(K_uu.rows());
+    return FitType(state_features, Eigen::SerializableLDLT(K_uu));
+  }
+
+  template <typename SpatialFeatureType>
+  static std::vector<SpatialFeatureType> get_spatial_features(
+      const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features) {
+    std::vector<SpatialFeatureType> spatial_features;
+    for (const auto &f : features) {
+      spatial_features.push_back(f.space);
+    }
+    return spatial_features;
+  }
+
+  /*
+   * Computes H = K_su K_uu^-1 along with the variance of each feature
+   * which is not explained by the state features.
+   */
+  template <typename FitType, typename SpatialFeatureType>
+  Eigen::MatrixXd
+  observation_matrix(const FitType &fit,
+                     const std::vector<SpatialFeatureType> &spatial_features,
+                     Eigen::VectorXd *unexplained) const {
+    const Eigen::MatrixXd K_us =
+        covariance_function_(fit.state_features, spatial_features);
+    const Eigen::MatrixXd H = fit.state_covariance.solve(K_us).transpose();
+
+    unexplained->resize(static_cast<Eigen::Index>(spatial_features.size()));
+    for (Eigen::Index i = 0; i < unexplained->size(); ++i) {
+      const auto &s = spatial_features[static_cast<std::size_t>(i)];
+      const double explained = H.row(i).dot(K_us.col(i));
+      (*unexplained)[i] =
+          std::max(covariance_function_(s, s) - explained, 0.);
+    }
+    return H;
+  }
+
+  template <typename FitType>
+  details::StateDistribution prior_state(const FitType &fit) const {
+    const Eigen::MatrixXd K_uu = fit.state_covariance.reconstructedMatrix();
+    const Eigen::Index n = temporal_process_.state_dimension() * K_uu.rows();
+    return {Eigen::VectorXd::Zero(n),
+            details::kronecker_product(
+                temporal_process_.stationary_covariance(), K_uu)};
+  }
+
+  // The distribution of the state dt after `state`, along with the
+  // transition matrix used.
+  details::StateDistribution propagate(const details::StateDistribution &state,
+                                       double dt, const Eigen::MatrixXd &K_uu,
+                                       Eigen::MatrixXd *transition) const {
+    const Eigen::MatrixXd F_t = temporal_process_.transition(dt);
+    const Eigen::MatrixXd P_t = temporal_process_.stationary_covariance();
+    const Eigen::MatrixXd Q_t = P_t - F_t * P_t * F_t.transpose();
+
+    const Eigen::MatrixXd I =
+        Eigen::MatrixXd::Identity(K_uu.rows(), K_uu.cols());
+    *transition = details::kronecker_product(F_t, I);
+    Eigen::MatrixXd covariance =
+        (*transition) * state.covariance * transition->transpose() +
+        details::kronecker_product(Q_t, K_uu);
+    return {(*transition) * state.mean, covariance};
+  }
+
+  // One step of the Rauch-Tung-Striebel smoother which combines the
+  // filtered state at some time with the smoothed state dt later.
+  details::StateDistribution
+  smooth(const details::StateDistribution &filtered, double dt,
+         const details::StateDistribution &next_smoothed,
+         const Eigen::MatrixXd &K_uu) const {
+    Eigen::MatrixXd F;
+    const auto predicted = propagate(filtered, dt, K_uu, &F);
+    // G = P_f F^T P_p^-1
+    const Eigen::MatrixXd G =
+        predicted.covariance.ldlt().solve(F * filtered.covariance).transpose();
+    const Eigen::VectorXd mean =
+        filtered.mean + G * (next_smoothed.mean - predicted.mean);
+    Eigen::MatrixXd covariance =
+        filtered.covariance +
+        G * (next_smoothed.covariance - predicted.covariance) *
+            G.transpose();
+    return {mean, 0.5 * (covariance + covariance.transpose())};
+  }
+
+  /*
+   * Runs the Kalman filter through the epochs in the features, appending
+   * the filtered states to `fit` and returning the log likelihood of the
+   * targets.
+   */
+  template <typename SpatialFeatureType, typename FitType>
+  double
+  filter(const std::vector<SpaceTimeFeature<SpatialFeatureType>> &features,
+         const MarginalDistribution &targets, FitType *fit) const {
+    assert(features.size() == static_cast<std::size_t>(targets.size()));
+
+    const Eigen::MatrixXd K_uu = fit->state_covariance.reconstructedMatrix();
+    const Eigen::Index m = K_uu.rows();
+
+    auto get_time = [](const auto &f) { return f.time; };
+    const auto epochs = group_by(features, get_time).indexers();
+
+    double log_likelihood = 0.;
+    for (const auto &pair : epochs) {
+      const double time = pair.first;
+
+      details::StateDistribution state;
+      bool same_epoch = false;
+      if (fit->times.empty()) {
+        state = prior_state(*fit);
+      } else {
+        const double dt = time - fit->times.back();
+        assert(dt >= 0. && "Epochs must be filtered in order of time");
+        same_epoch = (dt == 0.);
+        Eigen::MatrixXd F;
+        state = propagate({fit->means.back(), fit->covariances.back()}, dt,
+                          K_uu, &F);
+      }
+
+      const auto epoch_features = subset(features, pair.second);
+      const auto spatial_features = get_spatial_features(epoch_features);
+      const auto epoch_targets = subset(targets, pair.second);
+
+      Eigen::VectorXd unexplained;
+      const Eigen::MatrixXd H =
+          observation_matrix(*fit, spatial_features, &unexplained);
+
+      // Measurement noise is made up of the target uncertainty, any
+      // measurement only spatial covariance and the unexplained variance.
+      Eigen::MatrixXd R =
+          covariance_function_(as_measurements(spatial_features)) -
+          covariance_function_(spatial_features);
+      R.diagonal() += epoch_targets.covariance.diagonal() + unexplained;
+
+      // Only the first m elements of the state are observed.
+      const Eigen::MatrixXd PHt = state.covariance.leftCols(m) * H.transpose();
+      const Eigen::MatrixXd S = H * PHt.topRows(m) + R;
+      const Eigen::SerializableLDLT S_ldlt(S);
+      const Eigen::VectorXd innovation =
+          epoch_targets.mean - H * state.mean.head(m);
+      const Eigen::VectorXd S_inv_innovation = S_ldlt.solve(innovation);
+
+      state.mean += PHt * S_inv_innovation;
+      Eigen::MatrixXd covariance =
+          state.covariance - PHt * S_ldlt.solve(PHt.transpose());
+      state.covariance = 0.5 * (covariance + covariance.transpose());
+
+      log_likelihood -= 0.5 * (innovation.dot(S_inv_innovation) +
+                               S_ldlt.log_determinant() +
+                               static_cast<double>(S.rows()) * log(2 * M_PI));
+
+      if (same_epoch) {
+        fit->means.back() = std::move(state.mean);
+        fit->covariances.back() = std::move(state.covariance);
+      } else {
+        fit->times.push_back(time);
+        fit->means.emplace_back(std::move(state.mean));
+        fit->covariances.emplace_back(std::move(state.covariance));
+      }
+    }
+    return log_likelihood;
+  }
+
+  /*
+   * The distribution of the state at each of the (sorted) times given
+   * all the data in the fit.  The smoother only runs back as far as the
+   * earliest of the times.
+   */
+  template <typename FitType>
+  std::vector<details::StateDistribution>
+  smoothed_states(const FitType &fit, const std::vector<double> &times) const {
+    assert(std::is_sorted(times.begin(), times.end()));
+
+    std::vector<details::StateDistribution> output;
+    if (fit.times.empty()) {
+      const auto prior = prior_state(fit);
+      output.resize(times.size(), prior);
+      return output;
+    }
+
+    const Eigen::MatrixXd K_uu = fit.state_covariance.reconstructedMatrix();
+    const std::size_t n = fit.times.size();
+
+    // smoothed[k] holds the smoothed state at epoch k, once computed.
+    std::vector<details::StateDistribution> smoothed(n);
+    smoothed[n - 1] = {fit.means[n - 1], fit.covariances[n - 1]};
+    std::size_t earliest_smoothed = n - 1;
+    auto get_smoothed = [&](std::size_t k) {
+      while (earliest_smoothed > k) {
+        const std::size_t j = earliest_smoothed - 1;
+        smoothed[j] =
+            smooth({fit.means[j], fit.covariances[j]},
+                   fit.times[j + 1] - fit.times[j], smoothed[j + 1], K_uu);
+        earliest_smoothed = j;
+      }
+      return smoothed[k];
+    };
+
+    for (const double time : times) {
+      // The first epoch after `time`.
+      const std::size_t next = static_cast<std::size_t>(std::distance(
+          fit.times.begin(),
+          std::upper_bound(fit.times.begin(), fit.times.end(), time)));
+
+      Eigen::MatrixXd F;
+      if (next == n) {
+        // Forecasting from the last epoch.
+        output.push_back(propagate({fit.means[n - 1], fit.covariances[n - 1]},
+                                   time - fit.times[n - 1], K_uu, &F));
+      } else if (next == 0) {
+        // Before any of the data the filtered state is the prior.
+        output.push_back(smooth(prior_state(fit), fit.times[0] - time,
+                                get_smoothed(0), K_uu));
+      } else {
+        const auto filtered =
+            propagate({fit.means[next - 1], fit.covariances[next - 1]},
+                      time - fit.times[next - 1], K_uu, &F);
+        output.push_back(smooth(filtered, fit.times[next] - time,
+                                get_smoothed(next), K_uu));
+      }
+    }
+    return output;
+  }
+
+  CovFunc covariance_function_;
+  TemporalProcess temporal_process_;
+  StateFeatureStrategy state_feature_strategy_;
+};
+
+template <typename CovFunc, typename TemporalProcess>
+inline SpatioTemporalGaussianProcess<CovFunc, TemporalProcess>
+spatio_temporal_gp(const CovFunc &covariance_function,
+                   const TemporalProcess &temporal_process) {
+  return SpatioTemporalGaussianProcess<CovFunc, TemporalProcess>(
+      covariance_function, temporal_process);
+}
+
+template <typename CovFunc, typename TemporalProcess,
+          typename StateFeatureStrategy>
+inline SpatioTemporalGaussianProcess<CovFunc, TemporalProcess,
+                                     StateFeatureStrategy>
+spatio_temporal_gp(const CovFunc &covariance_function,
+                   const TemporalProcess &temporal_process,
+                   const StateFeatureStrategy &state_feature_strategy) {
+  return SpatioTemporalGaussianProcess<CovFunc, TemporalProcess,
+                                       StateFeatureStrategy>(
+      covariance_function, temporal_process, state_feature_strategy);
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_MODELS_SPATIO_TEMPORAL_GP_H_ */
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_MODELS_THINNING_H_
+#define INCLUDE_ALBATROSS_MODELS_THINNING_H_
+
+namespace albatross {
+
+/*
+ * Dense sampling often results in data which is largely redundant,
+ * many of the observations barely change the posterior but still
+ * contribute to the O(n^3) cost of fitting.  The tools in this file
+ * reduce a dataset to a smaller one with (nearly) the same posterior
+ * before it's handed to the model.
+ *
+ * A thinning strategy is any object with a call operator of the form:
+ *
+ *   RegressionDataset<FeatureType> operator()(
+ *       const ModelType &model,
+ *       const RegressionDataset<FeatureType> &dataset) const;
+ */
+
+struct ThinningSummary {
+  std::size_t input_size = 0;
+  std::size_t output_size = 0;
+
+  // The fraction of the data which was removed.
+  double reduction() const {
+    if (input_size == 0) {
+      return 0.;
+    }
+    return 1. - static_cast<double>(output_size) /
+                    static_cast<double>(input_size);
+  }
+
+  Insights insights() const {
+    Insights output;
+    output["input_size"] = std::to_string(input_size);
+    output["output_size"] = std::to_string(output_size);
+    output["reduction"] = std::to_string(reduction());
+    return output;
+  }
+
+  bool operator==(const ThinningSummary &other) const {
+    return (input_size == other.input_size &&
+            output_size == other.output_size);
+  }
+};
+
+namespace details {
+
+/*
+ * Combines repeated observations of the same feature into a single
+ * observation with the same information, ie the inverse variance
+ * weighted mean.
+ */
+inline std::pair<double, double>
+combine_observations(const MarginalDistribution &targets,
+                     const GroupIndices &indices) {
+  assert(indices.size() > 0);
+  const Eigen::VectorXd variances = targets.covariance.diagonal();
+
+  bool all_positive = true;
+  for (const auto &i : indices) {
+    const Eigen::Index ii = static_cast<Eigen::Index>(i);
+    all_positive = all_positive && variances[ii] > 0.;
+  }
+
+  double sum_weights = 0.;
+  double weighted_sum = 0.;
+  for (const auto &i : indices) {
+    const Eigen::Index ii = static_cast<Eigen::Index>(i);
+    const double weight = all_positive ? 1. / variances[ii] : 1.;
+    sum_weights += weight;
+    weighted_sum += weight * targets.mean[ii];
+  }
+
+  if (all_positive) {
+    return std::make_pair(weighted_sum / sum_weights, 1. / sum_weights);
+  }
+  // Without a variance for every observation we fall back to an
+  // unweighted mean.
+  const double n = static_cast<double>(indices.size());
+  const double variance = subset(variances, indices).sum() / (n * n);
+  return std::make_pair(weighted_sum / sum_weights, variance);
+}
+
+/*
+ * Greedily selects the observations which carry the most information
+ * about the latent function until no remaining observation would add
+ * more than `tolerance` nats, or `max_size` have been selected.
+ *
+ * This amounts to a pivoted, incremental, Cholesky decomposition of
+ * K + N where N is the observation noise.  Each step adds one row to
+ *
+ *   V = L^-1 K_{selected, all}
+ *
+ * and the posterior variance of the latent function at each of the
+ * observations, given the selected observations, is then
+ *
+ *   d = diag(K) - colwise_sum(V^2).
+ *
+ * The information gained from observing i is 0.5 log(1 + d_i / N_i),
+ * so the cost is O(n m^2) for m selected observations instead of the
+ * O(n^3) required for the full fit.  V grows as observations are
+ * selected so memory is O(n m) regardless of `max_size`.
+ */
+template <typename CovFunc, typename FeatureType>
+inline std::vector<std::size_t>
+greedy_information_gain_indices(const CovFunc &covariance_function,
+                                const std::vector<FeatureType> &features,
+                                const Eigen::VectorXd &noise,
+                                double tolerance, std::size_t max_size) {
+  const std::size_t n = features.size();
+  assert(static_cast<std::size_t>(noise.size()) == n);
+  const std::size_t m = std::min(n, max_size);
+
+  Eigen::VectorXd residual = covariance_function.diagonal(features);
+  // Row major so adding a row only appends to the buffer.
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> V(
+      static_cast<Eigen::Index>(std::min(m, std::size_t(16))),
+      static_cast<Eigen::Index>(n));
+  std::vector<bool> selected(n, false);
+  std::vector<std::size_t> output;
+
+  auto information_gain = [&](std::size_t i) {
+    const Eigen::Index ii = static_cast<Eigen::Index>(i);
+    if (residual[ii] <= 0.) {
+      return 0.;
+    }
+    if (noise[ii] <= 0.) {
+      return std::numeric_limits<double>::infinity();
+    }
+    return 0.5 * std::log1p(residual[ii] / noise[ii]);
+  };
+
+  while (output.size() < m) {
+    std::size_t best = n;
+    double best_gain = -1.;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!selected[i]) {
+        const double gain = information_gain(i);
+        if (gain > best_gain) {
+          best_gain = gain;
+          best = i;
+        }
+      }
+    }
+
+    if (best == n || best_gain < tolerance) {
+      break;
+    }
+
+    const Eigen::Index k = static_cast<Eigen::Index>(output.size());
+    const Eigen::Index j = static_cast<Eigen::Index>(best);
+    if (k == V.rows()) {
+      const std::size_t rows = std::min(m, 2 * output.size());
+      V.conservativeResize(static_cast<Eigen::Index>(rows), V.cols());
+    }
+    const Eigen::VectorXd l = V.topRows(k).col(j);
+    const double pivot = std::sqrt(residual[j] + noise[j]);
+    const Eigen::VectorXd cross =
+        covariance_function(std::vector<FeatureType>{features[best]},
+                            features)
+            .row(0)
+            .transpose();
+    V.row(k) = (cross - V.topRows(k).transpose() * l).transpose() / pivot;
+    residual -= V.row(k).transpose().cwiseAbs2();
+
+    selected[best] = true;
+    output.push_back(best);
+  }
+
+  std::sort(output.begin(), output.end());
+  return output;
+}
+
+} // namespace details
+
+/*
+ * Replaces all the observations which share a key, as determined by
+ * the grouper, with a single observation located at the first feature in
+ * the group.  The targets are combined using the inverse variance
+ * weighted mean so if the features in each group are truly identical
+ * (and the noise is independent) the posterior is unchanged.
+ */
+template <typename GrouperFunction> struct AggregateDuplicatesThinning {
+
+  AggregateDuplicatesThinning(){};
+
+  AggregateDuplicatesThinning(const GrouperFunction &grouper_)
+      : grouper(grouper_){};
+
+  template <typename ModelType, typename FeatureType>
+  RegressionDataset<FeatureType>
+  operator()(const ModelType &,
+             const RegressionDataset<FeatureType> &dataset) const {
+    const auto indexers = group_by(dataset.features, grouper).indexers();
+
+    std::vector<FeatureType> features;
+    Eigen::VectorXd mean(static_cast<Eigen::Index>(indexers.size()));
+    Eigen::VectorXd variance(static_cast<Eigen::Index>(indexers.size()));
+    Eigen::Index i = 0;
+    for (const auto &pair : indexers) {
+      features.push_back(dataset.features[pair.second[0]]);
+      const auto combined =
+          details::combine_observations(dataset.targets, pair.second);
+      mean[i] = combined.first;
+      variance[i] = combined.second;
+      ++i;
+    }
+    return RegressionDataset<FeatureType>(
+        features, MarginalDistribution(mean, variance));
+  }
+
+  GrouperFunction grouper;
+};
+
+/*
+ * Keeps only the observations which are informative given the others,
+ * see details::greedy_information_gain_indices.  The tolerance is the
+ * information gain, in nats, below which an observation is discarded.
+ * This requires a model which exposes get_covariance(), ie one of the
+ * Gaussian processes.
+ */
+struct GreedyInformationGainThinning {
+
+  GreedyInformationGainThinning()
+      : tolerance(0.1), max_size(std::numeric_limits<std::size_t>::max()){};
+
+  GreedyInformationGainThinning(double tolerance_, std::size_t max_size_)
+      : tolerance(tolerance_), max_size(max_size_){};
+
+  template <typename ModelType, typename FeatureType>
+  RegressionDataset<FeatureType>
+  operator()(const ModelType &model,
+             const RegressionDataset<FeatureType> &dataset) const {
+    const auto covariance_function = model.get_covariance();
+    // Noise which the covariance function only applies to measurements
+    // is included along with the noise in the targets.
+    const Eigen::VectorXd measurement_noise =
+        covariance_function.diagonal(as_measurements(dataset.features)) -
+        covariance_function.diagonal(dataset.features);
+    const Eigen::VectorXd noise =
+        dataset.targets.covariance.diagonal() + measurement_noise;
+
+    const auto indices = details::greedy_information_gain_indices(
+        covariance_function, dataset.features, noise, tolerance, max_size);
+    return subset(dataset, indices);
+  }
+
+  double tolerance;
+  std::size_t max_size;
+};
+
+/*
+ * Applies one thinning strategy followed by another, for example
+ * aggregating duplicates before a greedy selection.
+ */
+template <typename FirstStrategy, typename SecondStrategy>
+struct ChainedThinning {
+
+  ChainedThinning(){};
+
+  ChainedThinning(const FirstStrategy &first_, const SecondStrategy &second_)
+      : first(first_), second(second_){};
+
+  template <typename ModelType, typename FeatureType>
+  RegressionDataset<FeatureType>
+  operator()(const ModelType &model,
+             const RegressionDataset<FeatureType> &dataset) const {
+    return second(model, first(model, dataset));
+  }
+
+  FirstStrategy first;
+  SecondStrategy second;
+};
+
+template <typename GrouperFunction>
+inline auto aggregate_duplicates_thinning(const GrouperFunction &grouper) {
+  return AggregateDuplicatesThinning<GrouperFunction>(grouper);
+}
+
+template <typename FirstStrategy, typename SecondStrategy>
+inline auto chain_thinning(const FirstStrategy &first,
+                           const SecondStrategy &second) {
+  return ChainedThinning<FirstStrategy, SecondStrategy>(first, second);
+}
+
+template <typename ModelType, typename FeatureType> struct ThinnedFit {};
+
+template <typename ModelType, typename FeatureType>
+struct Fit<ThinnedFit<ModelType, FeatureType>> {
+
+  using FitModelType = typename fit_model_type<ModelType, FeatureType>::type;
+
+  Fit(){};
+
+  Fit(FitModelType &&fit_model_, const ThinningSummary &summary_)
+      : fit_model(std::move(fit_model_)), summary(summary_){};
+
+  bool operator==(const Fit &other) const {
+    return (fit_model == other.fit_model && summary == other.summary);
+  }
+
+  FitModelType fit_model;
+  ThinningSummary summary;
+};
+
+/*
+ * This wraps any other model and thins the data each time fit is called.
+ */
+template <typename ModelType, typename StrategyType>
+class Thinned : public ModelBase<Thinned<ModelType, StrategyType>> {
+public:
+  Thinned(){};
+
+  Thinned(const ModelType &sub_model, const StrategyType &strategy)
+      : sub_model_(sub_model), strategy_(strategy){};
+
+  std::string get_name() const {
+    return "thinned[" + sub_model_.get_name() + "]";
+  };
+
+  ParameterStore get_params() const override { return sub_model_.get_params(); }
+
+  void unchecked_set_param(const std::string &name,
+                           const Parameter &param) override {
+    sub_model_.set_param(name, param);
+  }
+
+  template <typename FeatureType>
+  auto thin(const RegressionDataset<FeatureType> &dataset) const {
+    return strategy_(sub_model_, dataset);
+  }
+
+  template <typename FeatureType>
+  Fit<ThinnedFit<ModelType, FeatureType>>
+  _fit_impl(const std::vector<FeatureType> &features,
+            const MarginalDistribution &targets) const {
+    const RegressionDataset<FeatureType> dataset(features, targets);
+    const auto thinned = thin(dataset);
+
+    ThinningSummary summary;
+    summary.input_size = dataset.size();
+    summary.output_size = thinned.size();
+
+    return Fit<ThinnedFit<ModelType, FeatureType>>(sub_model_.fit(thinned),
+                                                   summary);
+  }
+
+  template <typename PredictFeatureType, typename FitType, typename PredictType>
+  PredictType _predict_impl(const std::vector<PredictFeatureType> &features,
+                            const FitType &thinned_fit,
+                            PredictTypeIdentity<PredictType> &&) const {
+    return thinned_fit.fit_model.predict(features)
+        .template get<PredictType>();
+  }
+
+  ModelType sub_model_;
+  StrategyType strategy_;
+};
+
+template <typename ModelType>
+template <typename StrategyType>
+Thinned<ModelType, StrategyType>
+ModelBase<ModelType>::thinned(const StrategyType &strategy) const {
+  return Thinned<ModelType, StrategyType>(derived(), strategy);
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_MODELS_THINNING_H_ */
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2019 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef ALBATROSS_TUNE_MULTI_FIDELITY_H
+#define ALBATROSS_TUNE_MULTI_FIDELITY_H
+
+/*
+ * Evaluating a tuning metric on the full dataset typically costs O(n^3),
+ * yet most candidate parameters can be ruled out using a small fraction
+ * of the data.  The MultiFidelityTuner implements successive halving:
+ *
+ *   - A set of candidate parameters is evaluated on a small subset,
+ *   - the best 1 / eta of them are promoted to a subset eta times larger,
+ *   - which is repeated until the subset is the full dataset (or a single
+ *     candidate remains),
+ *
+ * after which the best candidate is polished with a local nlopt
+ * optimization on the full dataset.
+ *
+ * The same subset is used for every candidate within a round so their
+ * metrics are directly comparable.
+ */
+
+namespace albatross {
+
+struct MultiFidelityConfig {
+  // Number of candidates evaluated in the first round, this includes
+  // the model's initial parameters.
+  std::size_t num_candidates = 27;
+  // Fraction of the dataset used in the first round.
+  double initial_fraction = 0.05;
+  // Factor by which the subset grows (and the candidates shrink)
+  // between rounds.
+  double eta = 3.;
+  // Candidates are drawn uniformly within this distance of the initial
+  // parameters in the tuning space (which is log space for log scale
+  // priors), clipped to the prior bounds.
+  double search_radius = 2.;
+  // Maximum number of full dataset evaluations used by the final
+  // nlopt polish, zero skips the polish entirely.
+  int polish_evaluations = 20;
+};
+
+namespace details {
+
+inline std::size_t fidelity_subset_size(std::size_t n, double fraction) {
+  const auto k = static_cast<std::size_t>(
+      std::ceil(fraction * static_cast<double>(n)));
+  return std::min(n, std::max(k, std::size_t(1)));
+}
+
+inline std::vector<std::vector<double>>
+multi_fidelity_candidates(const ParameterStore &params,
+                          const MultiFidelityConfig &config,
+                          std::default_random_engine &gen) {
+  const auto tunable = get_tunable_parameters(params);
+  std::uniform_real_distribution<double> uniform(-1., 1.);
+
+  std::vector<std::vector<double>> output = {tunable.values};
+  while (output.size() < config.num_candidates) {
+    std::vector<double> candidate(tunable.values);
+    for (std::size_t i = 0; i < candidate.size(); ++i) {
+      candidate[i] += config.search_radius * uniform(gen);
+      candidate[i] = std::max(candidate[i], tunable.lower_bounds[i]);
+      candidate[i] = std::min(candidate[i], tunable.upper_bounds[i]);
+    }
+    output.emplace_back(candidate);
+  }
+  return output;
+}
+
+} // namespace details
+
+/*
+ * A random subset of the dataset containing the given fraction of
+ * the features.
+ */
+struct RandomSubset {
+  template <typename FeatureType>
+  RegressionDataset<FeatureType>
+  operator()(const RegressionDataset<FeatureType> &dataset, double fraction,
+             std::default_random_engine &gen) const {
+    const std::size_t n = dataset.size();
+    const std::size_t k = details::fidelity_subset_size(n, fraction);
+    if (k >= n) {
+      return dataset;
+    }
+    return subset(dataset, randint_without_replacement(k, 0, n - 1, gen));
+  }
+};
+
+/*
+ * Samples the same fraction from each group produced by GrouperFunction,
+ * useful to make sure every station, day, etc ... is represented in the
+ * smaller subsets.
+ */
+template <typename GrouperFunction> struct StratifiedSubset {
+
+  StratifiedSubset(const GrouperFunction &grouper_) : grouper(grouper_){};
+
+  template <typename FeatureType>
+  RegressionDataset<FeatureType>
+  operator()(const RegressionDataset<FeatureType> &dataset, double fraction,
+             std::default_random_engine &gen) const {
+    if (fraction >= 1.) {
+      return dataset;
+    }
+    GroupIndices inds;
+    for (const auto &pair : dataset.group_by(grouper).indexers()) {
+      const std::size_t n = pair.second.size();
+      const std::size_t k = details::fidelity_subset_size(n, fraction);
+      for (const auto &i : randint_without_replacement(k, 0, n - 1, gen)) {
+        inds.push_back(pair.second[i]);
+      }
+    }
+    std::sort(inds.begin(), inds.end());
+    return subset(dataset, inds);
+  }
+
+  GrouperFunction grouper;
+};
+
+template <typename GrouperFunction>
+inline auto stratified_subset(const GrouperFunction &grouper) {
+  return StratifiedSubset<GrouperFunction>(grouper);
+}
+
+template <typename ModelType, typename MetricType, typename FeatureType,
+          typename SubsetFunction = RandomSubset>
+struct MultiFidelityTuner {
+  ModelType model;
+  MetricType metric;
+  RegressionDataset<FeatureType> dataset;
+  MultiFidelityConfig config;
+  SubsetFunction subset_function;
+  std::ostream &output_stream;
+  nlopt::opt optimizer;
+  std::default_random_engine gen;
+
+  static_assert(is_model_metric<MetricType, FeatureType, ModelType>::value,
+                "metric is not valid for this feature/model pair");
+
+  MultiFidelityTuner(const ModelType &model_, const MetricType &metric_,
+                     const RegressionDataset<FeatureType> &dataset_,
+                     const MultiFidelityConfig &config_,
+                     const SubsetFunction &subset_function_,
+                     std::ostream &output_stream_)
+      : model(model_), metric(metric_), dataset(dataset_), config(config_),
+        subset_function(subset_function_), output_stream(output_stream_),
+        optimizer(), gen(2012) {
+    assert(config.num_candidates > 0);
+    assert(config.initial_fraction > 0. && config.initial_fraction <= 1.);
+    assert(config.eta > 1.);
+    optimizer = default_optimizer(model.get_params());
+  };
+
+  ParameterStore tune() {
+    const ParameterStore initial_params = model.get_params();
+
+    auto evaluate = [&](const std::vector<double> &x,
+                        const RegressionDataset<FeatureType> &data) {
+      ModelType m(model);
+      m.set_params(set_tunable_params_values(initial_params, x));
+      double value = this->metric(data, m);
+      if (std::isnan(value)) {
+        value = INFINITY;
+      }
+      return value;
+    };
+
+    auto candidates =
+        details::multi_fidelity_candidates(initial_params, config, gen);
+    std::vector<double> scores;
+
+    double fraction = config.initial_fraction;
+    while (true) {
+      const auto data = subset_function(dataset, fraction, gen);
+
+      scores.clear();
+      for (const auto &candidate : candidates) {
+        scores.push_back(evaluate(candidate, data));
+      }
+
+      output_stream << "==================" << std::endl;
+      output_stream << "MULTI FIDELITY ROUND" << std::endl;
+      output_stream << "candidates: " << candidates.size()
+                    << " size: " << data.size() << " best: "
+                    << *std::min_element(scores.begin(), scores.end())
+                    << std::endl;
+
+      if (fraction >= 1. || candidates.size() == 1) {
+        break;
+      }
+
+      const std::size_t keep = std::max(
+          std::size_t(1),
+          static_cast<std::size_t>(static_cast<double>(candidates.size()) /
+                                   config.eta));
+      std::vector<std::size_t> order(candidates.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [&](const std::size_t &i, const std::size_t &j) {
+                         return scores[i] < scores[j];
+                       });
+      candidates = subset(candidates, std::vector<std::size_t>(
+                                          order.begin(), order.begin() + keep));
+      fraction = std::min(1., fraction * config.eta);
+    }
+
+    const auto best = static_cast<std::size_t>(std::distance(
+        scores.begin(), std::min_element(scores.begin(), scores.end())));
+    const ParameterStore best_params =
+        set_tunable_params_values(initial_params, candidates[best]);
+
+    if (config.polish_evaluations <= 0) {
+      output_stream << pretty_params(best_params) << std::endl;
+      return best_params;
+    }
+
+    auto objective = [&](const ParameterStore &params) {
+      ModelType m(model);
+      m.set_params(params);
+      return this->metric(this->dataset, m);
+    };
+
+    GenericTuner polish(best_params, output_stream);
+    polish.optimizer = optimizer;
+    polish.optimizer.set_maxeval(config.polish_evaluations);
+    return polish.tune(objective);
+  }
+};
+
+template <typename ModelType, typename MetricType, typename FeatureType,
+          typename SubsetFunction = RandomSubset>
+auto get_multi_fidelity_tuner(
+    const ModelType &model, const MetricType &metric,
+    const RegressionDataset<FeatureType> &dataset,
+    const MultiFidelityConfig &config = MultiFidelityConfig(),
+    const SubsetFunction &subset_function = SubsetFunction(),
+    std::ostream &output_stream = std::cout) {
+  return MultiFidelityTuner<ModelType, MetricType, FeatureType,
+                            SubsetFunction>(model, metric, dataset, config,
+                                            subset_function, output_stream);
+}
+
+} // namespace albatross
+#endif
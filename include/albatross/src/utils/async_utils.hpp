@@ -42,6 +42,45 @@ void async_apply(const std::vector<ValueType> &xs, const ApplyFunction &func) {
   }
 }
 
+/*
+ * Like async_apply but with at most `max_workers` threads alive at a
+ * time, each of which takes the next unprocessed element as soon as it
+ * finishes the previous one.  Useful when the number of elements is
+ * fixed by something other than the number of available cores.
+ */
+template <typename ValueType, typename ApplyFunction,
+          typename ApplyType = typename details::value_only_apply_result<
+              ApplyFunction, ValueType>::type,
+          typename std::enable_if<details::is_valid_value_only_apply_function<
+                                      ApplyFunction, ValueType>::value &&
+                                      std::is_same<void, ApplyType>::value,
+                                  int>::type = 0>
+void bounded_async_apply(const std::vector<ValueType> &xs,
+                         const ApplyFunction &func, std::size_t max_workers) {
+  const std::size_t workers =
+      std::min(xs.size(), std::max(max_workers, std::size_t(1)));
+  if (workers <= 1) {
+    for (const auto &x : xs) {
+      func(x);
+    }
+    return;
+  }
+
+  std::atomic<std::size_t> next(0);
+  auto work = [&]() {
+    for (std::size_t i = next++; i < xs.size(); i = next++) {
+      func(xs[i]);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  for (std::size_t i = 0; i < workers; ++i) {
+    futures.emplace_back(async_safe(work));
+  }
+  for (auto &f : futures) {
+    f.get();
+  }
+}
+
 template <typename ValueType, typename ApplyFunction,
           typename ApplyType = typename details::value_only_apply_result<
               ApplyFunction, ValueType>::type,
@@ -19,17 +19,36 @@ namespace albatross {
  * One approach to dealing with block linear algebra is to cluster everything
  * into groups these subsequent methods make those representations easier to
  * work with.
+ *
+ * Blocks are summed using a pairwise tree, the shape of which only depends
+ * on the number of blocks, so the result doesn't depend on how (or in what
+ * order) the blocks were computed.  This also accumulates less rounding
+ * error than a running sum.
  */
+namespace details {
+
 template <typename MatrixType>
-inline Eigen::MatrixXd block_sum(const std::vector<MatrixType> &xs) {
-  MatrixType output = xs[0];
-  for (std::size_t i = 1; i < xs.size(); ++i) {
-    // Eigen internally asserts that the results are the same size.
-    output += xs[i];
+inline MatrixType tree_sum(const std::vector<MatrixType> &xs,
+                           std::size_t first, std::size_t count) {
+  assert(count > 0);
+  if (count == 1) {
+    return xs[first];
   }
+  const std::size_t half = count / 2;
+  MatrixType output = tree_sum(xs, first, half);
+  // Eigen internally asserts that the results are the same size.
+  output += tree_sum(xs, first + half, count - half);
   return output;
 }
 
+} // namespace details
+
+template <typename MatrixType>
+inline Eigen::MatrixXd block_sum(const std::vector<MatrixType> &xs) {
+  assert(!xs.empty());
+  return details::tree_sum(xs, 0, xs.size());
+}
+
 template <typename GroupKey, typename MatrixType>
 inline MatrixType block_sum(const Grouped<GroupKey, MatrixType> &xs) {
   return block_sum(xs.values());
@@ -139,6 +158,136 @@ inline auto block_diag_solve(const Grouped<GroupKey, Solver> &lhs,
   return rhs.apply(solve_one_block);
 };
 
+/*
+ * Parallel versions of the block operations above.  Groups are split
+ * into contiguous chunks which are handed out to a bounded number of
+ * workers (see TuningParameters::threads), each worker keeps a running
+ * sum over its chunk and the partial sums are then combined using the
+ * same pairwise tree as block_sum.  There is one chunk per worker unless
+ * execution is deterministic, in which case the chunks only depend on
+ * the number of groups.
+ */
+namespace details {
+
+constexpr std::size_t deterministic_groups_per_chunk = 4;
+
+inline std::vector<std::pair<Eigen::Index, Eigen::Index>>
+group_chunks(std::size_t num_groups, const TuningParameters &params) {
+  const std::size_t num_chunks =
+      deterministic_execution()
+          ? (num_groups + deterministic_groups_per_chunk - 1) /
+                deterministic_groups_per_chunk
+          : tuning_threads(params);
+  return large_matrix_column_blocks(static_cast<Eigen::Index>(num_groups),
+                                    num_chunks);
+}
+
+/*
+ * Sums term(i) for i in [0, n) in parallel.
+ */
+template <typename TermFunction>
+inline Eigen::MatrixXd async_chunked_sum(std::size_t n,
+                                         const TermFunction &term) {
+  assert(n > 0);
+  const auto params = get_tuning_parameters();
+  const auto chunks = group_chunks(n, params);
+
+  std::vector<Eigen::MatrixXd> partial_sums(chunks.size());
+  std::vector<std::size_t> chunk_indices(chunks.size());
+  std::iota(chunk_indices.begin(), chunk_indices.end(), 0);
+  auto sum_one_chunk = [&](std::size_t i) {
+    const std::size_t first = static_cast<std::size_t>(chunks[i].first);
+    const std::size_t count = static_cast<std::size_t>(chunks[i].second);
+    Eigen::MatrixXd sum = term(first);
+    for (std::size_t j = first + 1; j < first + count; ++j) {
+      sum += term(j);
+    }
+    partial_sums[i] = std::move(sum);
+  };
+  bounded_async_apply(chunk_indices, sum_one_chunk, tuning_threads(params));
+  return block_sum(partial_sums);
+}
+
+} // namespace details
+
+template <typename MatrixType>
+inline Eigen::MatrixXd async_block_sum(const std::vector<MatrixType> &xs) {
+  return details::async_chunked_sum(
+      xs.size(), [&](std::size_t i) { return Eigen::MatrixXd(xs[i]); });
+}
+
+template <typename GroupKey, typename MatrixType>
+inline Eigen::MatrixXd
+async_block_sum(const Grouped<GroupKey, MatrixType> &xs) {
+  return async_block_sum(xs.values());
+}
+
+template <typename GroupKey, typename X, typename Y, typename ApplyFunction>
+inline Eigen::MatrixXd
+async_block_accumulate(const Grouped<GroupKey, X> &lhs,
+                       const Grouped<GroupKey, Y> &rhs,
+                       const ApplyFunction &apply_function) {
+  static_assert(
+      std::is_same<Eigen::MatrixXd,
+                   typename invoke_result<ApplyFunction, X, Y>::type>::value,
+      "apply_function needs to return an Eigen::MatrixXd type");
+
+  assert(lhs.size() == rhs.size());
+  assert(lhs.size() > 0);
+
+  const auto keys = lhs.keys();
+  auto one_group = [&](std::size_t i) {
+    assert(map_contains(lhs, keys[i]) && map_contains(rhs, keys[i]));
+    return apply_function(lhs.at(keys[i]), rhs.at(keys[i]));
+  };
+  return details::async_chunked_sum(keys.size(), one_group);
+}
+
+template <typename GroupKey>
+inline Eigen::MatrixXd
+async_block_product(const Grouped<GroupKey, Eigen::MatrixXd> &lhs,
+                    const Grouped<GroupKey, Eigen::MatrixXd> &rhs) {
+  auto matrix_product = [&](const auto &x, const auto &y) {
+    return (x * y).eval();
+  };
+  return async_block_accumulate(lhs, rhs, matrix_product);
+}
+
+template <typename GroupKey>
+inline Eigen::MatrixXd
+async_block_inner_product(const Grouped<GroupKey, Eigen::MatrixXd> &lhs,
+                          const Grouped<GroupKey, Eigen::MatrixXd> &rhs) {
+  auto matrix_inner_product = [&](const auto &x, const auto &y) {
+    return (x.transpose() * y).eval();
+  };
+  return async_block_accumulate(lhs, rhs, matrix_inner_product);
+}
+
+/*
+ * Each block is solved independently so there is no reduction involved,
+ * the output is identical to block_diag_solve.
+ */
+template <typename GroupKey, typename Solver, typename Rhs>
+inline Grouped<GroupKey, Eigen::MatrixXd>
+async_block_diag_solve(const Grouped<GroupKey, Solver> &lhs,
+                       const Grouped<GroupKey, Rhs> &rhs) {
+  const auto keys = rhs.keys();
+  std::vector<Eigen::MatrixXd> solved(keys.size());
+  std::vector<std::size_t> indices(keys.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  auto solve_one_block = [&](std::size_t i) {
+    solved[i] = lhs.at(keys[i]).solve(rhs.at(keys[i]));
+  };
+  bounded_async_apply(indices, solve_one_block,
+                      tuning_threads(get_tuning_parameters()));
+
+  Grouped<GroupKey, Eigen::MatrixXd> output;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    output.emplace(keys[i], std::move(solved[i]));
+  }
+  return output;
+}
+
 template <typename GroupKey>
 inline Grouped<GroupKey, Eigen::MatrixXd>
 block_subtract(const Grouped<GroupKey, Eigen::MatrixXd> &lhs,
@@ -224,6 +373,50 @@ struct BlockDiagonal {
   Eigen::MatrixXd toDense() const;
 };
 
+template <typename Solver> struct AppendedBlockSymmetric {
+
+  /*
+   * Equivalent to repeatedly nesting BlockSymmetric, ie
+   *
+   *   BlockSymmetric<BlockSymmetric<...<Solver>>>
+   *
+   * with one level for each appended block, but with a type which
+   * doesn't change as blocks are appended.  This makes it possible to
+   * build one up at run time, for example while replaying a log of
+   * updates to a fit.  Each appended block is stored the same way as
+   * in BlockSymmetric, as Ai_B = A^-1 B and the LDLT of the Schur
+   * complement S = C - B^T A^-1 B where A is everything before it.
+   */
+  AppendedBlockSymmetric(){};
+
+  AppendedBlockSymmetric(const Solver &A_) : A(A_), Ai_Bs(), Ss(){};
+
+  void append(const Eigen::MatrixXd &Ai_B, const Eigen::SerializableLDLT &S);
+
+  template <class _Scalar, int _Rows, int _Cols>
+  Eigen::Matrix<_Scalar, _Rows, _Cols>
+  solve(const Eigen::Matrix<_Scalar, _Rows, _Cols> &rhs) const;
+
+  bool operator==(const AppendedBlockSymmetric &rhs) const;
+
+  Eigen::Index rows() const;
+
+  Eigen::Index cols() const;
+
+  // Requires that Solver provide reconstructedMatrix (as Eigen's LDLT does).
+  Eigen::MatrixXd reconstructedMatrix() const;
+
+  Solver A;
+  std::vector<Eigen::MatrixXd> Ai_Bs;
+  std::vector<Eigen::SerializableLDLT> Ss;
+
+private:
+  Eigen::MatrixXd solve_leading(std::size_t k,
+                                const Eigen::MatrixXd &rhs) const;
+
+  Eigen::Index leading_rows(std::size_t k) const;
+};
+
 template <typename Solver> struct BlockSymmetric {
 
   /*
@@ -529,6 +722,105 @@ inline Eigen::Index BlockDiagonal::cols() const {
   return n;
 }
 
+/*
+ * AppendedBlockSymmetric
+ *
+ */
+
+template <typename Solver>
+inline void
+AppendedBlockSymmetric<Solver>::append(const Eigen::MatrixXd &Ai_B,
+                                       const Eigen::SerializableLDLT &S) {
+  assert(Ai_B.rows() == rows());
+  assert(Ai_B.cols() == S.rows());
+  Ai_Bs.push_back(Ai_B);
+  Ss.push_back(S);
+}
+
+template <typename Solver>
+template <class _Scalar, int _Rows, int _Cols>
+inline Eigen::Matrix<_Scalar, _Rows, _Cols>
+AppendedBlockSymmetric<Solver>::solve(
+    const Eigen::Matrix<_Scalar, _Rows, _Cols> &rhs) const {
+  assert(rhs.rows() == rows());
+  const Eigen::MatrixXd output = solve_leading(Ss.size(), rhs);
+  return output;
+}
+
+template <typename Solver>
+inline Eigen::MatrixXd AppendedBlockSymmetric<Solver>::solve_leading(
+    std::size_t k, const Eigen::MatrixXd &rhs) const {
+  if (k == 0) {
+    return A.solve(rhs);
+  }
+  // The same steps as BlockSymmetric::solve where the leading k - 1
+  // blocks play the role of A.
+  const auto &Ai_B = Ai_Bs[k - 1];
+  const auto &S = Ss[k - 1];
+  const Eigen::Index n_a = leading_rows(k - 1);
+
+  const Eigen::MatrixXd rhs_a = rhs.topRows(n_a);
+  const Eigen::MatrixXd rhs_b = rhs.bottomRows(S.rows());
+
+  // The recursive solve returns a temporary, so intermediate results
+  // are evaluated instead of being held as lazy expressions.
+  const Eigen::MatrixXd Si_Bt_Ai_rhs = S.solve(Ai_B.transpose() * rhs_a);
+  const Eigen::MatrixXd Si_rhs_b = S.solve(rhs_b);
+
+  Eigen::MatrixXd output(n_a + S.rows(), rhs.cols());
+  output.topRows(n_a) =
+      solve_leading(k - 1, rhs_a) + Ai_B * (Si_Bt_Ai_rhs - Si_rhs_b);
+  output.bottomRows(S.rows()) = Si_rhs_b - Si_Bt_Ai_rhs;
+
+  return output;
+}
+
+template <typename Solver>
+inline Eigen::Index
+AppendedBlockSymmetric<Solver>::leading_rows(std::size_t k) const {
+  Eigen::Index n = A.rows();
+  for (std::size_t i = 0; i < k; ++i) {
+    n += Ss[i].rows();
+  }
+  return n;
+}
+
+template <typename Solver>
+inline bool AppendedBlockSymmetric<Solver>::
+operator==(const AppendedBlockSymmetric &rhs) const {
+  return (A == rhs.A && Ai_Bs == rhs.Ai_Bs && Ss == rhs.Ss);
+}
+
+template <typename Solver>
+inline Eigen::Index AppendedBlockSymmetric<Solver>::rows() const {
+  return leading_rows(Ss.size());
+}
+
+template <typename Solver>
+inline Eigen::Index AppendedBlockSymmetric<Solver>::cols() const {
+  return rows();
+}
+
+template <typename Solver>
+inline Eigen::MatrixXd
+AppendedBlockSymmetric<Solver>::reconstructedMatrix() const {
+  // Each block is recovered from B = A Ai_B and C = S + B^T Ai_B.
+  Eigen::MatrixXd output = A.reconstructedMatrix();
+  for (std::size_t i = 0; i < Ss.size(); ++i) {
+    const Eigen::Index n_a = output.rows();
+    const Eigen::Index n_b = Ss[i].rows();
+    const Eigen::MatrixXd B = output * Ai_Bs[i];
+    Eigen::MatrixXd next(n_a + n_b, n_a + n_b);
+    next.topLeftCorner(n_a, n_a) = output;
+    next.topRightCorner(n_a, n_b) = B;
+    next.bottomLeftCorner(n_b, n_a) = B.transpose();
+    next.bottomRightCorner(n_b, n_b) =
+        Ss[i].reconstructedMatrix() + B.transpose() * Ai_Bs[i];
+    output = std::move(next);
+  }
+  return output;
+}
+
 /*
  * BlockSymmetric
  *
@@ -545,14 +837,19 @@ inline Eigen::Matrix<_Scalar, _Rows, _Cols> BlockSymmetric<Solver>::solve(
   const Eigen::MatrixXd rhs_a = rhs.topRows(A.rows());
   const Eigen::MatrixXd rhs_b = rhs.bottomRows(S.rows());
 
-  const auto Bt_Ai_rhs = Ai_B.transpose() * rhs_a;
+  const Eigen::MatrixXd Bt_Ai_rhs = Ai_B.transpose() * rhs_a;
 
-  const auto Si_Bt_Ai_rhs = S.solve(Bt_Ai_rhs);
-  const auto upper_left = A.solve(rhs_a) + Ai_B * Si_Bt_Ai_rhs;
+  // A may itself be a block matrix whose solve returns a temporary, so
+  // these are evaluated rather than held as lazy expressions.  The
+  // differences are also taken before multiplying by Ai_B which avoids
+  // cancellation between two large products.
+  const Eigen::MatrixXd Si_Bt_Ai_rhs = S.solve(Bt_Ai_rhs);
+  const Eigen::MatrixXd Si_rhs_b = S.solve(rhs_b);
 
   Eigen::Matrix<_Scalar, _Rows, _Cols> output(n, rhs.cols());
-  output.topRows(A.rows()) = upper_left - Ai_B * S.solve(rhs_b);
-  output.bottomRows(S.rows()) = S.solve(rhs_b) - Si_Bt_Ai_rhs;
+  output.topRows(A.rows()) =
+      A.solve(rhs_a) + Ai_B * (Si_Bt_Ai_rhs - Si_rhs_b);
+  output.bottomRows(S.rows()) = Si_rhs_b - Si_Bt_Ai_rhs;
 
   return output;
 }
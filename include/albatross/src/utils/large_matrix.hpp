@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_SRC_UTILS_LARGE_MATRIX_HPP_
+#define INCLUDE_ALBATROSS_SRC_UTILS_LARGE_MATRIX_HPP_
+
+/*
+ * Large dense buffers (covariance matrices and cross covariances) are
+ * typically allocated by one thread and then written by many.  On multi
+ * socket machines the operating system places each page on the NUMA
+ * node of the thread which first touches it and multi GB buffers made
+ * of regular pages put a lot of pressure on the TLB.
+ *
+ * allocate_large_matrix() returns an uninitialized Eigen::MatrixXd which,
+ * when it exceeds a size threshold, has been advised to use transparent
+ * huge pages.  None of its pages are touched, it's meant for outputs
+ * which are assembled in parallel (such as the Gram distance assembly)
+ * so the first touch of each page is done by the worker which fills it
+ * and pages follow the same column blocks as the work.  Buffers which
+ * are filled serially should simply use Eigen::MatrixXd.
+ */
+
+namespace albatross {
+
+struct LargeMatrixPolicy {
+  // Buffers smaller than this are left entirely to the default allocator.
+  std::size_t min_bytes = std::size_t(64) << 20;
+  // Advise the kernel to back the buffer with transparent huge pages.
+  bool huge_pages = true;
+};
+
+namespace details {
+
+/*
+ * A small, trivially copyable, value which is read from many threads
+ * and occasionally replaced.  Readers never lock, they retry if the
+ * value was being replaced while they copied it (a sequence lock).
+ * Writers have to be serialized by the caller.
+ */
+template <typename T> class AtomicSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "AtomicSnapshot requires a trivially copyable type");
+
+public:
+  explicit AtomicSnapshot(const T &value) : version_(0), words_() {
+    store(value);
+  }
+
+  // Sequentially consistent operations are used throughout, on common
+  // platforms the loads are as cheap as relaxed ones and only the
+  // (rare) writers pay for the ordering.
+  T load() const {
+    Words words;
+    while (true) {
+      const std::size_t version = version_.load();
+      if (version % 2 == 0) {
+        for (std::size_t i = 0; i < words.size(); ++i) {
+          words[i] = words_[i].load();
+        }
+        if (version_.load() == version) {
+          break;
+        }
+      }
+    }
+    T value;
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+  void store(const T &value) {
+    Words words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    const std::size_t version = version_.load();
+    version_.store(version + 1);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+      words_[i].store(words[i]);
+    }
+    version_.store(version + 2);
+  }
+
+private:
+  using Words = std::array<std::uint64_t, (sizeof(T) + 7) / 8>;
+
+  std::atomic<std::size_t> version_;
+  std::array<std::atomic<std::uint64_t>, (sizeof(T) + 7) / 8> words_;
+};
+
+/*
+ * The policy is read on every allocation, potentially from many threads.
+ */
+struct LargeMatrixPolicyState {
+  LargeMatrixPolicyState() : mutex(), policy(LargeMatrixPolicy()) {}
+
+  std::mutex mutex;
+  AtomicSnapshot<LargeMatrixPolicy> policy;
+};
+
+inline LargeMatrixPolicyState &large_matrix_policy_state() {
+  static LargeMatrixPolicyState state;
+  return state;
+}
+
+inline void advise_huge_pages(double *data, std::size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const std::uintptr_t page =
+      static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+  const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data);
+  const std::uintptr_t aligned_begin = (begin + page - 1) / page * page;
+  const std::uintptr_t aligned_end = (begin + bytes) / page * page;
+  if (aligned_end > aligned_begin) {
+    // This is only advice, if the kernel doesn't support transparent
+    // huge pages the buffer is simply backed by regular pages.
+    madvise(reinterpret_cast<void *>(aligned_begin),
+            aligned_end - aligned_begin, MADV_HUGEPAGE);
+  }
+#else
+  (void)data;
+  (void)bytes;
+#endif
+}
+
+} // namespace details
+
+/*
+ * The policy is global and may be changed at any time, it only affects
+ * buffers allocated after the change.
+ */
+inline LargeMatrixPolicy get_large_matrix_policy() {
+  return details::large_matrix_policy_state().policy.load();
+}
+
+inline void set_large_matrix_policy(const LargeMatrixPolicy &policy) {
+  auto &state = details::large_matrix_policy_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.policy.store(policy);
+}
+
+/*
+ * Splits `cols` columns into at most `num_blocks` contiguous blocks of
+ * nearly equal size, returned as (first column, number of columns) pairs.
+ * Since Eigen matrices are column major each block is a contiguous piece
+ * of memory.
+ */
+inline std::vector<std::pair<Eigen::Index, Eigen::Index>>
+large_matrix_column_blocks(Eigen::Index cols, std::size_t num_blocks) {
+  std::vector<std::pair<Eigen::Index, Eigen::Index>> blocks;
+  if (cols <= 0) {
+    return blocks;
+  }
+  const Eigen::Index n = std::min(
+      cols, static_cast<Eigen::Index>(std::max(num_blocks, std::size_t(1))));
+  const Eigen::Index base_size = cols / n;
+  const Eigen::Index remainder = cols % n;
+  Eigen::Index first = 0;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    const Eigen::Index size = base_size + (i < remainder ? 1 : 0);
+    blocks.emplace_back(first, size);
+    first += size;
+  }
+  return blocks;
+}
+
+inline Eigen::MatrixXd
+allocate_large_matrix(Eigen::Index rows, Eigen::Index cols,
+                      const LargeMatrixPolicy &policy) {
+  Eigen::MatrixXd output(rows, cols);
+  const std::size_t bytes =
+      static_cast<std::size_t>(output.size()) * sizeof(double);
+  if (bytes < policy.min_bytes || bytes == 0) {
+    return output;
+  }
+
+  if (policy.huge_pages) {
+    details::advise_huge_pages(output.data(), bytes);
+  }
+  return output;
+}
+
+inline Eigen::MatrixXd allocate_large_matrix(Eigen::Index rows,
+                                             Eigen::Index cols) {
+  return allocate_large_matrix(rows, cols, get_large_matrix_policy());
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_SRC_UTILS_LARGE_MATRIX_HPP_ */
@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_SRC_UTILS_MAPPED_FIT_HPP_
+#define INCLUDE_ALBATROSS_SRC_UTILS_MAPPED_FIT_HPP_
+
+/*
+ * A storage format for fits which is meant to be memory mapped instead
+ * of deserialized.  Many processes on the same host can then load the
+ * same (potentially multi GB) fit and share a single copy of it in the
+ * page cache, and loading only costs as much as touching the pages which
+ * are actually used.
+ *
+ * A file consists of a header, a table describing each of the named
+ * arrays and the raw array data.  Each array starts on a page aligned
+ * offset so it can be used in place through an Eigen::Map.  The arrays
+ * are written in the native byte order, files are not meant to be moved
+ * between architectures.
+ *
+ * For a Gaussian process fit the LDLT factor is used directly from the
+ * mapping through a MappedLDLT.  The information vector and features are
+ * stored in the file as well but, since Fit<GPFit<>> and the covariance
+ * functions work with Eigen::VectorXd and std::vector, those O(n) pieces
+ * are copied out when loading.
+ */
+
+namespace albatross {
+
+namespace details {
+
+constexpr char mapped_fit_magic[8] = {'A', 'L', 'B', 'M', 'F', 'I', 'T', '\0'};
+constexpr std::uint32_t mapped_fit_version = 1;
+constexpr std::uint64_t mapped_fit_alignment = 4096;
+constexpr std::size_t mapped_fit_max_name_length = 47;
+
+struct MappedFitHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_arrays;
+};
+
+struct MappedFitArrayEntry {
+  char name[mapped_fit_max_name_length + 1];
+  std::uint64_t offset;
+  std::uint64_t rows;
+  std::uint64_t cols;
+  std::uint64_t element_size;
+};
+
+inline std::uint64_t mapped_fit_align(std::uint64_t offset) {
+  return (offset + mapped_fit_alignment - 1) / mapped_fit_alignment *
+         mapped_fit_alignment;
+}
+
+} // namespace details
+
+/*
+ * A read only mapping of an entire file which is released when the
+ * last reference to it goes away.
+ */
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) : data_(nullptr), size_(0) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("MappedFile: unable to open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      throw std::runtime_error("MappedFile: unable to stat " + path);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ > 0) {
+      // MAP_SHARED lets every process mapping the file use the same
+      // physical pages from the page cache.
+      void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("MappedFile: unable to map " + path);
+      }
+      data_ = static_cast<const char *>(data);
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data() const { return data_; }
+
+  std::size_t size() const { return size_; }
+
+private:
+  const char *data_;
+  std::size_t size_;
+};
+
+/*
+ * Collects named arrays and writes them out in the mapped fit format.
+ * The writer only holds pointers to the arrays, so they need to stay
+ * alive until write() is called.
+ */
+class MappedFitWriter {
+public:
+  void add(const std::string &name, const void *data, std::size_t rows,
+           std::size_t cols, std::size_t element_size) {
+    assert(name.size() <= details::mapped_fit_max_name_length);
+    arrays_.push_back({name, data, rows, cols, element_size});
+  }
+
+  template <typename Derived>
+  void add(const std::string &name, const Eigen::PlainObjectBase<Derived> &x) {
+    using Scalar = typename Derived::Scalar;
+    add(name, x.data(), static_cast<std::size_t>(x.rows()),
+        static_cast<std::size_t>(x.cols()), sizeof(Scalar));
+  }
+
+  template <typename T>
+  void add(const std::string &name, const std::vector<T> &xs) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable types can be mapped");
+    add(name, xs.data(), xs.size(), 1, sizeof(T));
+  }
+
+  void write(const std::string &path) const {
+    std::vector<details::MappedFitArrayEntry> entries;
+    std::uint64_t offset = details::mapped_fit_align(
+        sizeof(details::MappedFitHeader) +
+        arrays_.size() * sizeof(details::MappedFitArrayEntry));
+    for (const auto &array : arrays_) {
+      details::MappedFitArrayEntry entry;
+      std::memset(&entry, 0, sizeof(entry));
+      std::strncpy(entry.name, array.name.c_str(),
+                   details::mapped_fit_max_name_length);
+      entry.offset = offset;
+      entry.rows = array.rows;
+      entry.cols = array.cols;
+      entry.element_size = array.element_size;
+      entries.push_back(entry);
+      offset = details::mapped_fit_align(offset + array.bytes());
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error("MappedFitWriter: unable to open " + path);
+    }
+
+    details::MappedFitHeader header;
+    std::memcpy(header.magic, details::mapped_fit_magic, sizeof(header.magic));
+    header.version = details::mapped_fit_version;
+    header.num_arrays = static_cast<std::uint32_t>(arrays_.size());
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(entries.data()),
+                 static_cast<std::streamsize>(entries.size() *
+                                              sizeof(entries[0])));
+
+    std::uint64_t position =
+        sizeof(header) + entries.size() * sizeof(entries[0]);
+    const std::vector<char> padding(details::mapped_fit_alignment, 0);
+    for (std::size_t i = 0; i < arrays_.size(); ++i) {
+      stream.write(padding.data(),
+                   static_cast<std::streamsize>(entries[i].offset - position));
+      stream.write(static_cast<const char *>(arrays_[i].data),
+                   static_cast<std::streamsize>(arrays_[i].bytes()));
+      position = entries[i].offset + arrays_[i].bytes();
+    }
+
+    if (!stream) {
+      throw std::runtime_error("MappedFitWriter: failed writing " + path);
+    }
+  }
+
+private:
+  struct Array {
+    std::string name;
+    const void *data;
+    std::size_t rows;
+    std::size_t cols;
+    std::size_t element_size;
+
+    std::uint64_t bytes() const { return rows * cols * element_size; }
+  };
+
+  std::vector<Array> arrays_;
+};
+
+/*
+ * Read only access to the arrays in a mapped fit file.  Copies are
+ * cheap and all refer to the same mapping.
+ */
+class MappedFitFile {
+public:
+  MappedFitFile() : file_(), entries_(){};
+
+  explicit MappedFitFile(const std::string &path)
+      : file_(std::make_shared<const MappedFile>(path)), entries_() {
+    const char *data = file_->data();
+    const std::size_t size = file_->size();
+
+    details::MappedFitHeader header;
+    if (size < sizeof(header)) {
+      throw std::runtime_error("MappedFitFile: truncated header in " + path);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, details::mapped_fit_magic,
+                    sizeof(header.magic)) != 0 ||
+        header.version != details::mapped_fit_version) {
+      throw std::runtime_error("MappedFitFile: not a mapped fit " + path);
+    }
+
+    const std::size_t table_end =
+        sizeof(header) + header.num_arrays * sizeof(entries_[0]);
+    if (size < table_end) {
+      throw std::runtime_error("MappedFitFile: truncated table in " + path);
+    }
+    entries_.resize(header.num_arrays);
+    std::memcpy(entries_.data(), data + sizeof(header),
+                entries_.size() * sizeof(entries_[0]));
+
+    for (const auto &entry : entries_) {
+      const std::uint64_t bytes = entry.rows * entry.cols * entry.element_size;
+      if (entry.offset % details::mapped_fit_alignment != 0 ||
+          entry.offset + bytes > size) {
+        throw std::runtime_error("MappedFitFile: corrupt array in " + path);
+      }
+    }
+  }
+
+  bool contains(const std::string &name) const {
+    return find(name) != nullptr;
+  }
+
+  Eigen::Map<const Eigen::MatrixXd> matrix(const std::string &name) const {
+    const auto &entry = get(name, sizeof(double));
+    return Eigen::Map<const Eigen::MatrixXd>(
+        pointer<double>(entry), static_cast<Eigen::Index>(entry.rows),
+        static_cast<Eigen::Index>(entry.cols));
+  }
+
+  Eigen::Map<const Eigen::VectorXd> vector(const std::string &name) const {
+    const auto &entry = get(name, sizeof(double));
+    assert(entry.cols == 1);
+    return Eigen::Map<const Eigen::VectorXd>(
+        pointer<double>(entry), static_cast<Eigen::Index>(entry.rows));
+  }
+
+  template <typename T> const T *data(const std::string &name) const {
+    return pointer<T>(get(name, sizeof(T)));
+  }
+
+  std::size_t size(const std::string &name) const {
+    const auto *entry = find(name);
+    return entry == nullptr ? 0 : entry->rows * entry->cols;
+  }
+
+private:
+  const details::MappedFitArrayEntry *find(const std::string &name) const {
+    for (const auto &entry : entries_) {
+      if (name == entry.name) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  const details::MappedFitArrayEntry &get(const std::string &name,
+                                          std::size_t element_size) const {
+    const auto *entry = find(name);
+    if (entry == nullptr) {
+      throw std::runtime_error("MappedFitFile: missing array " + name);
+    }
+    if (entry->element_size != element_size) {
+      throw std::runtime_error("MappedFitFile: unexpected element size for " +
+                               name);
+    }
+    return *entry;
+  }
+
+  template <typename T>
+  const T *pointer(const details::MappedFitArrayEntry &entry) const {
+    return reinterpret_cast<const T *>(file_->data() + entry.offset);
+  }
+
+  std::shared_ptr<const MappedFile> file_;
+  std::vector<details::MappedFitArrayEntry> entries_;
+};
+
+/*
+ * An LDLT decomposition which lives in a mapped fit file.  It provides
+ * the subset of the SerializableLDLT interface needed to make
+ * predictions and works directly on the mapped factor.
+ */
+class MappedLDLT {
+public:
+  using StorageIndex = Eigen::LDLT<Eigen::MatrixXd>::TranspositionType::
+      IndicesType::Scalar;
+
+  MappedLDLT()
+      : file_(), matrix_(nullptr), size_(0), transpositions_(nullptr){};
+
+  MappedLDLT(const MappedFitFile &file, const std::string &prefix)
+      : file_(file), matrix_(file.data<double>(prefix + "_matrix")),
+        size_(static_cast<Eigen::Index>(file.size(prefix + "_transpositions"))),
+        transpositions_(file.data<StorageIndex>(prefix + "_transpositions")) {
+    if (file.size(prefix + "_matrix") !=
+        static_cast<std::size_t>(size_ * size_)) {
+      throw std::runtime_error("MappedLDLT: inconsistent " + prefix);
+    }
+  }
+
+  Eigen::Index rows() const { return size_; }
+
+  Eigen::Index cols() const { return size_; }
+
+  Eigen::Map<const Eigen::MatrixXd> matrixLDLT() const {
+    return Eigen::Map<const Eigen::MatrixXd>(matrix_, size_, size_);
+  }
+
+  Eigen::VectorXd vectorD() const { return matrixLDLT().diagonal(); }
+
+  /*
+   * Mirrors Eigen::LDLT::solve so results match those from the
+   * original decomposition exactly.
+   */
+  template <typename Rhs>
+  Eigen::MatrixXd solve(const Eigen::MatrixBase<Rhs> &rhs) const {
+    assert(rhs.rows() == rows());
+    const auto matrix = matrixLDLT();
+    Eigen::MatrixXd output(rhs);
+    apply_transpositions(&output);
+    matrix.triangularView<Eigen::UnitLower>().solveInPlace(output);
+    const double tolerance = std::numeric_limits<double>::min();
+    for (Eigen::Index i = 0; i < output.rows(); ++i) {
+      const double d = matrix(i, i);
+      if (std::abs(d) > tolerance) {
+        output.row(i) /= d;
+      } else {
+        output.row(i).setZero();
+      }
+    }
+    matrix.transpose().triangularView<Eigen::UnitUpper>().solveInPlace(output);
+    apply_transpositions_transpose(&output);
+    return output;
+  }
+
+  double log_determinant() const {
+    return vectorD().array().log().sum();
+  }
+
+  bool operator==(const MappedLDLT &other) const {
+    return size_ == other.size_ &&
+           matrixLDLT() == other.matrixLDLT() &&
+           std::equal(transpositions_, transpositions_ + size_,
+                      other.transpositions_);
+  }
+
+private:
+  void apply_transpositions(Eigen::MatrixXd *x) const {
+    for (Eigen::Index k = 0; k < rows(); ++k) {
+      const Eigen::Index j = static_cast<Eigen::Index>(transpositions_[k]);
+      if (j != k) {
+        x->row(k).swap(x->row(j));
+      }
+    }
+  }
+
+  void apply_transpositions_transpose(Eigen::MatrixXd *x) const {
+    for (Eigen::Index k = rows() - 1; k >= 0; --k) {
+      const Eigen::Index j = static_cast<Eigen::Index>(transpositions_[k]);
+      if (j != k) {
+        x->row(k).swap(x->row(j));
+      }
+    }
+  }
+
+  // Keeps the mapping alive for as long as the pointers below are used.
+  MappedFitFile file_;
+  const double *matrix_;
+  Eigen::Index size_;
+  const StorageIndex *transpositions_;
+};
+
+/*
+ * Writes a Gaussian process fit in the mapped fit format.
+ */
+template <typename FeatureType>
+inline void save_mapped_gp_fit(
+    const std::string &path,
+    const Fit<GPFit<Eigen::SerializableLDLT, FeatureType>> &fit) {
+  static_assert(std::is_trivially_copyable<FeatureType>::value,
+                "Mapped fits require trivially copyable features");
+  const auto &indices = fit.train_covariance.transpositionsP().indices();
+
+  MappedFitWriter writer;
+  writer.add("train_covariance_matrix", fit.train_covariance.matrixLDLT());
+  writer.add("train_covariance_transpositions", indices);
+  writer.add("information", fit.information);
+  writer.add("train_features", fit.train_features);
+  writer.write(path);
+}
+
+template <typename FeatureType>
+inline Fit<GPFit<MappedLDLT, FeatureType>>
+load_mapped_gp_fit(const std::string &path) {
+  static_assert(std::is_trivially_copyable<FeatureType>::value,
+                "Mapped fits require trivially copyable features");
+  const MappedFitFile file(path);
+
+  Fit<GPFit<MappedLDLT, FeatureType>> fit;
+  fit.train_covariance = MappedLDLT(file, "train_covariance");
+  fit.information = file.vector("information");
+  const FeatureType *features = file.data<FeatureType>("train_features");
+  fit.train_features.assign(features,
+                            features + file.size("train_features"));
+  if (fit.information.size() != fit.train_covariance.rows() ||
+      fit.train_features.size() !=
+          static_cast<std::size_t>(fit.information.size())) {
+    throw std::runtime_error("load_mapped_gp_fit: inconsistent fit in " +
+                             path);
+  }
+  return fit;
+}
+
+/*
+ * Loads a mapped fit and pairs it with the model which produced it.
+ */
+template <typename FeatureType, typename ModelType>
+inline auto load_mapped_gp_fit_model(const ModelType &model,
+                                     const std::string &path) {
+  using FitType = Fit<GPFit<MappedLDLT, FeatureType>>;
+  return FitModel<ModelType, FitType>(model,
+                                      load_mapped_gp_fit<FeatureType>(path));
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_SRC_UTILS_MAPPED_FIT_HPP_ */
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_SRC_UTILS_PROCESS_UTILS_HPP_
+#define INCLUDE_ALBATROSS_SRC_UTILS_PROCESS_UTILS_HPP_
+
+/*
+ * process_apply is the multi process analog of async_apply.  Each
+ * element of a map is handed to a forked worker process which applies
+ * the function, serializes the result with cereal and writes it back to
+ * the coordinating process through a pipe.
+ *
+ * Since the workers are forked they start with a (copy on write) view
+ * of the coordinator's memory, so the inputs don't need to be
+ * serialized, only the results do.  Any memory a worker allocates is
+ * released when it exits which isolates the coordinator from the peak
+ * memory use and fragmentation of the individual sub problems.
+ *
+ * The result of the function must be default constructible and
+ * serializable with cereal.
+ *
+ * fork() only copies the calling thread, so any lock held by another
+ * thread at the time (including ones inside malloc or a logger) stays
+ * locked forever in the workers.  process_apply should be called before
+ * the process starts any threads of its own, or at least while no other
+ * threads are running.
+ */
+
+namespace albatross {
+
+namespace details {
+
+inline void wait_for_process(pid_t pid, int *status) {
+  while (waitpid(pid, status, 0) < 0 && errno == EINTR) {
+  }
+}
+
+/*
+ * Owns the read end of a worker's pipe and the worker itself.  Once the
+ * result has been collected both are released, if the worker is
+ * destroyed before that (because another worker failed) the pipe is
+ * closed and the process is killed and reaped so it doesn't outlive the
+ * call as a zombie.
+ */
+struct ProcessWorker {
+  ProcessWorker(pid_t pid_, int fd_) : pid(pid_), fd(fd_){};
+
+  ProcessWorker(const ProcessWorker &) = delete;
+  ProcessWorker &operator=(const ProcessWorker &) = delete;
+
+  ProcessWorker(ProcessWorker &&other) : pid(other.pid), fd(other.fd) {
+    other.pid = -1;
+    other.fd = -1;
+  }
+
+  ~ProcessWorker() {
+    if (fd >= 0) {
+      close(fd);
+    }
+    if (pid > 0) {
+      kill(pid, SIGKILL);
+      int status = 0;
+      wait_for_process(pid, &status);
+    }
+  }
+
+  pid_t pid;
+  int fd;
+};
+
+inline bool write_all(int fd, const std::string &payload) {
+  std::size_t written = 0;
+  while (written < payload.size()) {
+    const ssize_t n =
+        write(fd, payload.data() + written, payload.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+inline std::string read_all(int fd) {
+  std::string payload;
+  char buffer[1 << 16];
+  while (true) {
+    const ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    payload.append(buffer, static_cast<std::size_t>(n));
+  }
+  return payload;
+}
+
+template <typename Function>
+inline ProcessWorker spawn_process_worker(Function &&f) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    throw std::runtime_error("process_apply: unable to create a pipe");
+  }
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    throw std::runtime_error("process_apply: unable to fork a worker");
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    int status = 1;
+    try {
+      std::ostringstream oss;
+      {
+        cereal::BinaryOutputArchive archive(oss);
+        archive(f());
+      }
+      status = write_all(fds[1], oss.str()) ? 0 : 1;
+    } catch (...) {
+      status = 1;
+    }
+    close(fds[1]);
+    // Skip any exit handlers inherited from the coordinator.
+    _exit(status);
+  }
+
+  close(fds[1]);
+  return ProcessWorker(pid, fds[0]);
+}
+
+template <typename ResultType>
+inline ResultType collect_process_worker(ProcessWorker *worker) {
+  // The pipe has to be drained before waiting on the worker, otherwise
+  // a worker with a large result would block forever on the write.
+  const std::string payload = read_all(worker->fd);
+  close(worker->fd);
+  worker->fd = -1;
+
+  int status = 0;
+  wait_for_process(worker->pid, &status);
+  worker->pid = -1;
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw std::runtime_error("process_apply: worker process failed");
+  }
+
+  ResultType output;
+  std::istringstream iss(payload);
+  cereal::BinaryInputArchive archive(iss);
+  archive(output);
+  return output;
+}
+
+inline std::size_t default_process_count(std::size_t max_processes) {
+  if (max_processes > 0) {
+    return max_processes;
+  }
+  const auto concurrency = std::thread::hardware_concurrency();
+  return std::max(std::size_t(1), static_cast<std::size_t>(concurrency));
+}
+
+/*
+ * Runs `call(key, value)` for each element in a worker process keeping
+ * at most `max_processes` workers alive at a time.
+ */
+template <typename ResultType, typename KeyType, typename ValueType,
+          typename CallFunction>
+inline Grouped<KeyType, ResultType>
+process_apply_impl(const std::map<KeyType, ValueType> &xs,
+                   const CallFunction &call, std::size_t max_processes) {
+  const std::size_t num_processes = default_process_count(max_processes);
+
+  Grouped<KeyType, ResultType> output;
+  std::deque<std::pair<KeyType, ProcessWorker>> running;
+
+  // If collecting a result throws, the remaining workers are killed and
+  // reaped as `running` is destroyed.
+  auto collect_oldest = [&]() {
+    auto &oldest = running.front();
+    output[oldest.first] = collect_process_worker<ResultType>(&oldest.second);
+    running.pop_front();
+  };
+
+  for (const auto &pair : xs) {
+    if (running.size() >= num_processes) {
+      collect_oldest();
+    }
+    auto f = [&]() { return call(pair.first, pair.second); };
+    running.emplace_back(pair.first, spawn_process_worker(f));
+  }
+
+  while (!running.empty()) {
+    collect_oldest();
+  }
+  return output;
+}
+
+} // namespace details
+
+template <typename KeyType, typename ValueType, typename ApplyFunction,
+          typename ApplyType = typename details::value_only_apply_result<
+              ApplyFunction, ValueType>::type,
+          typename std::enable_if<details::is_valid_value_only_apply_function<
+                                      ApplyFunction, ValueType>::value &&
+                                      !std::is_same<void, ApplyType>::value,
+                                  int>::type = 0>
+inline Grouped<KeyType, ApplyType>
+process_apply(const std::map<KeyType, ValueType> &xs,
+              const ApplyFunction &func, std::size_t max_processes = 0) {
+  auto call = [&](const KeyType &, const ValueType &value) {
+    return func(value);
+  };
+  return details::process_apply_impl<ApplyType>(xs, call, max_processes);
+}
+
+template <
+    typename KeyType, typename ValueType, typename ApplyFunction,
+    typename ApplyType = typename details::key_value_apply_result<
+        ApplyFunction, KeyType, ValueType>::type,
+    typename std::enable_if<details::is_valid_key_value_apply_function<
+                                ApplyFunction, KeyType, ValueType>::value &&
+                                !std::is_same<void, ApplyType>::value,
+                            int>::type = 0>
+inline Grouped<KeyType, ApplyType>
+process_apply(const std::map<KeyType, ValueType> &xs,
+              const ApplyFunction &func, std::size_t max_processes = 0) {
+  return details::process_apply_impl<ApplyType>(xs, func, max_processes);
+}
+
+template <typename KeyType, typename ValueType, typename ApplyFunction>
+inline auto process_apply(const Grouped<KeyType, ValueType> &xs,
+                          const ApplyFunction &func,
+                          std::size_t max_processes = 0) {
+  return process_apply(xs.get_map(), func, max_processes);
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_SRC_UTILS_PROCESS_UTILS_HPP_ */
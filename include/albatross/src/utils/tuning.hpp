@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef INCLUDE_ALBATROSS_SRC_UTILS_TUNING_HPP_
+#define INCLUDE_ALBATROSS_SRC_UTILS_TUNING_HPP_
+
+/*
+ * The blocked kernels used to assemble large matrices have a few size and
+ * thread count parameters whose best values depend on the machine (cache
+ * sizes, SIMD width, number of cores).  They are collected here in
+ * TuningParameters which are global and can be:
+ *
+ *   - left at their defaults,
+ *   - overridden using set_tuning_parameters(),
+ *   - measured by calibrate_tuning_parameters() (see calibration.hpp),
+ *   - or, after a call to enable_auto_tuning(), calibrated the first time
+ *     they are needed and persisted to a cache file keyed by CPU model so
+ *     later processes on the same kind of machine can skip calibration.
+ *
+ * Separately, set_deterministic_execution(true) makes every parallel path
+ * produce bit identical results regardless of the number of threads or
+ * the tuning parameters.  Work is then split into partitions which only
+ * depend on the size of the problem, any parameters which change the
+ * arithmetic (as opposed to just how it's scheduled) are held at their
+ * defaults and reductions are done in a fixed order.  This only holds
+ * for the same build running on the same instruction set, Eigen picks
+ * its vectorized kernels based on the SIMD extensions available so
+ * results can still differ between CPUs.
+ */
+
+namespace albatross {
+
+struct TuningParameters {
+  // Features with at least this many coordinates have Euclidean
+  // distance matrices assembled from their Gram matrix.
+  Eigen::Index gram_distance_dimension = 8;
+  // Parallel assembly hands out column blocks with at least this many
+  // elements to each worker.
+  Eigen::Index parallel_block_size = 1 << 16;
+  // Number of workers used for parallel assembly, zero uses the
+  // hardware concurrency.
+  std::size_t threads = 0;
+
+  bool operator==(const TuningParameters &other) const {
+    return gram_distance_dimension == other.gram_distance_dimension &&
+           parallel_block_size == other.parallel_block_size &&
+           threads == other.threads;
+  }
+
+  bool operator!=(const TuningParameters &other) const {
+    return !(*this == other);
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const TuningParameters &params) {
+  os << "gram_distance_dimension: " << params.gram_distance_dimension
+     << ", parallel_block_size: " << params.parallel_block_size
+     << ", threads: " << params.threads;
+  return os;
+}
+
+/*
+ * The CPU model as reported by the operating system, used to key the
+ * tuning cache.
+ */
+inline std::string cpu_model_name() {
+#if defined(__linux__)
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      const auto colon = line.find(':');
+      if (colon != std::string::npos) {
+        const auto begin = line.find_first_not_of(" \t", colon + 1);
+        if (begin != std::string::npos) {
+          return line.substr(begin);
+        }
+      }
+    }
+  }
+#endif
+  return "unknown";
+}
+
+inline std::string default_tuning_cache_path() {
+  const char *cache_home = std::getenv("XDG_CACHE_HOME");
+  if (cache_home != nullptr && cache_home[0] != '\0') {
+    return std::string(cache_home) + "/albatross_tuning.txt";
+  }
+  const char *home = std::getenv("HOME");
+  if (home != nullptr && home[0] != '\0') {
+    return std::string(home) + "/.cache/albatross_tuning.txt";
+  }
+  return "albatross_tuning.txt";
+}
+
+/*
+ * The cache is a text file with one tab separated line per CPU model:
+ *
+ *   <cpu model>\t<gram_distance_dimension>\t<parallel_block_size>\t<threads>
+ */
+inline bool read_tuning_cache(const std::string &path,
+                              const std::string &cpu_model,
+                              TuningParameters *params) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    const auto tab = line.find('\t');
+    if (tab == std::string::npos || line.substr(0, tab) != cpu_model) {
+      continue;
+    }
+    std::istringstream values(line.substr(tab + 1));
+    TuningParameters cached;
+    if (values >> cached.gram_distance_dimension >>
+        cached.parallel_block_size >> cached.threads) {
+      *params = cached;
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace details {
+
+/*
+ * Creates `directory` along with any missing parents, returns true if
+ * the directory exists afterwards.
+ */
+inline bool make_directories(const std::string &directory) {
+  std::size_t end = 0;
+  while (end != std::string::npos) {
+    end = directory.find('/', end + 1);
+    // Failures are fine here (the parent may already exist or not be
+    // writable), all that matters is whether the directory exists.
+    mkdir(directory.substr(0, end).c_str(), 0755);
+  }
+  struct stat info;
+  return stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+} // namespace details
+
+/*
+ * Adds (or replaces) the entry for `cpu_model` leaving the entries for
+ * other CPU models untouched.  Returns false if the file couldn't be
+ * written.
+ *
+ * Several processes may start up and calibrate at the same time so the
+ * new contents are written to a temporary file which is then renamed
+ * into place, readers never see a partially written cache.  Concurrent
+ * writers can still drop each other's entries in which case the losing
+ * CPU model is simply calibrated again later.
+ */
+inline bool write_tuning_cache(const std::string &path,
+                               const std::string &cpu_model,
+                               const TuningParameters &params) {
+  const auto slash = path.rfind('/');
+  if (slash != std::string::npos && slash > 0 &&
+      !details::make_directories(path.substr(0, slash))) {
+    return false;
+  }
+
+  std::vector<std::string> lines;
+  {
+    std::ifstream existing(path);
+    std::string line;
+    while (std::getline(existing, line)) {
+      const auto tab = line.find('\t');
+      if (tab != std::string::npos && line.substr(0, tab) != cpu_model) {
+        lines.push_back(line);
+      }
+    }
+  }
+
+  std::ostringstream temporary_path;
+  temporary_path << path << ".tmp." << getpid() << "."
+                 << std::hash<std::thread::id>()(std::this_thread::get_id());
+  const std::string temporary = temporary_path.str();
+  {
+    std::ofstream file(temporary, std::ios::trunc);
+    for (const auto &line : lines) {
+      file << line << '\n';
+    }
+    file << cpu_model << '\t' << params.gram_distance_dimension << '\t'
+         << params.parallel_block_size << '\t' << params.threads << '\n';
+    file.close();
+    if (!file) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+namespace details {
+
+/*
+ * The parameters are read by every covariance assembly, potentially from
+ * many threads, so readers only load a snapshot without locking in the
+ * same way as LargeMatrixPolicyState.
+ */
+struct TuningState {
+  TuningState()
+      : mutex(), params(TuningParameters()), generation(0), calibrate(),
+        pending(false), cache_path(), deterministic(false) {}
+
+  std::mutex mutex;
+  AtomicSnapshot<TuningParameters> params;
+  // Incremented whenever the parameters are set or auto tuning is
+  // (re)enabled so a calibration which finishes afterwards is dropped.
+  std::size_t generation;
+  // Set by enable_auto_tuning(), the parameters are resolved (from the
+  // cache or by calibrating) the next time they are requested.  The
+  // mutex is only taken by readers while `pending` is set.
+  std::function<TuningParameters()> calibrate;
+  std::atomic<bool> pending;
+  std::string cache_path;
+  // Read without holding the mutex since it's needed by the kernels
+  // which may be running as part of calibration.
+  std::atomic<bool> deterministic;
+
+  // Must be called while holding the mutex.
+  void publish(const TuningParameters &new_params) {
+    params.store(new_params);
+    ++generation;
+  }
+};
+
+inline TuningState &tuning_state() {
+  static TuningState state;
+  return state;
+}
+
+/*
+ * The calibration callback is run without holding the mutex since it
+ * may well assemble covariance matrices, which request the parameters
+ * themselves.  Those requests (and any from other threads while the
+ * calibration runs) see the parameters from before auto tuning.
+ */
+inline void resolve_auto_tuning(TuningState *state) {
+  std::function<TuningParameters()> calibrate;
+  std::string cache_path;
+  std::size_t generation;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!state->calibrate) {
+      return;
+    }
+    std::swap(calibrate, state->calibrate);
+    cache_path = state->cache_path;
+    generation = state->generation;
+    state->pending.store(false, std::memory_order_release);
+  }
+
+  const std::string cpu_model = cpu_model_name();
+  TuningParameters params;
+  if (!read_tuning_cache(cache_path, cpu_model, &params)) {
+    params = calibrate();
+    write_tuning_cache(cache_path, cpu_model, params);
+  }
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (state->generation == generation) {
+    state->publish(params);
+  }
+}
+
+} // namespace details
+
+inline TuningParameters get_tuning_parameters() {
+  auto &state = details::tuning_state();
+  if (state.pending.load(std::memory_order_acquire)) {
+    details::resolve_auto_tuning(&state);
+  }
+  const TuningParameters params = state.params.load();
+  if (state.deterministic) {
+    TuningParameters fixed;
+    fixed.threads = params.threads;
+    return fixed;
+  }
+  return params;
+}
+
+/*
+ * Overrides the current parameters, including any which would have
+ * been found by pending auto tuning.
+ */
+inline void set_tuning_parameters(const TuningParameters &params) {
+  auto &state = details::tuning_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.publish(params);
+  state.calibrate = nullptr;
+  state.pending.store(false, std::memory_order_release);
+}
+
+inline void
+enable_auto_tuning(const std::function<TuningParameters()> &calibrate,
+                   const std::string &cache_path) {
+  auto &state = details::tuning_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.calibrate = calibrate;
+  state.cache_path = cache_path;
+  ++state.generation;
+  state.pending.store(true, std::memory_order_release);
+}
+
+inline void set_deterministic_execution(bool deterministic) {
+  details::tuning_state().deterministic = deterministic;
+}
+
+inline bool deterministic_execution() {
+  return details::tuning_state().deterministic;
+}
+
+inline std::size_t tuning_threads(const TuningParameters &params) {
+  if (params.threads > 0) {
+    return params.threads;
+  }
+  const auto concurrency = std::thread::hardware_concurrency();
+  return std::max(std::size_t(1), static_cast<std::size_t>(concurrency));
+}
+
+// When only the lower triangle of a matrix is assembled the first
+// column blocks hold most of the work, so each thread is handed several
+// smaller blocks which it picks up as it finishes the previous one.
+constexpr std::size_t lower_triangle_blocks_per_thread = 4;
+
+/*
+ * Column blocks for parallel assembly of a rows x cols matrix, each of
+ * which has at least roughly params.parallel_block_size elements.  There
+ * is typically one block per thread (several for a `lower_triangle`),
+ * unless execution is deterministic in which case the number of blocks
+ * only depends on the matrix size.  Either way they should be run using
+ * bounded_async_apply.
+ */
+inline std::vector<std::pair<Eigen::Index, Eigen::Index>>
+tuned_column_blocks(Eigen::Index rows, Eigen::Index cols,
+                    const TuningParameters &params,
+                    bool lower_triangle = false) {
+  const Eigen::Index block_size =
+      std::max(Eigen::Index(1), params.parallel_block_size);
+  const std::size_t max_blocks = static_cast<std::size_t>(
+      std::max(Eigen::Index(1), (rows * cols) / block_size));
+  if (deterministic_execution()) {
+    return large_matrix_column_blocks(cols, max_blocks);
+  }
+  std::size_t blocks = tuning_threads(params);
+  if (lower_triangle) {
+    blocks *= lower_triangle_blocks_per_thread;
+  }
+  return large_matrix_column_blocks(cols, std::min(blocks, max_blocks));
+}
+
+} // namespace albatross
+
+#endif /* INCLUDE_ALBATROSS_SRC_UTILS_TUNING_HPP_ */
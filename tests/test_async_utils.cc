@@ -45,6 +45,33 @@ TEST(test_async_utils, test_async_apply_with_capture) {
   EXPECT_NE(order_processed, xs);
 }
 
+TEST(test_async_utils, test_bounded_async_apply) {
+  std::vector<int> xs(20);
+  std::iota(xs.begin(), xs.end(), 0);
+
+  std::mutex mu;
+  int sum = 0;
+  std::size_t running = 0;
+  std::size_t max_running = 0;
+
+  auto add_to_sum = [&](const int x) {
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      ++running;
+      max_running = std::max(max_running, running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    std::lock_guard<std::mutex> lock(mu);
+    sum += x;
+    --running;
+  };
+
+  bounded_async_apply(xs, add_to_sum, 3);
+  EXPECT_EQ(sum, std::accumulate(xs.begin(), xs.end(), 0));
+  EXPECT_LE(max_running, 3);
+  EXPECT_GT(max_running, 1);
+}
+
 TEST(test_async_utils, test_async_apply_map_value_only_function) {
   std::map<std::string, int> xs = {{"0", 0}, {"1", 1}, {"2", 2},
                                    {"3", 3}, {"4", 4}, {"5", 5}};
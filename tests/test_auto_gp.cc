@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "test_models.h"
+
+#include <albatross/AutoGP>
+
+namespace albatross {
+
+inline AutoGPConfig unlimited_auto_gp_config() {
+  AutoGPConfig config;
+  config.memory_budget_bytes = std::numeric_limits<std::size_t>::max();
+  config.latency_target_seconds = 1e6;
+  config.max_patch_size = 50;
+  return config;
+}
+
+template <typename FitModelType>
+Insights chosen_model_insights(const FitModelType &fit_model) {
+  return fit_model.get_fit().fit_model.match(
+      [](const auto &m) { return m.get_model().insights; });
+}
+
+class AutoGPTest : public ::testing::Test {
+public:
+  AutoGPTest()
+      : dataset(make_toy_linear_data(5., 1., 0.1, 200)),
+        covariance(make_simple_covariance_function()),
+        strategy(10),
+        test_features(linspace(-10., 210., 23)) {}
+
+  auto make_model(const AutoGPConfig &config) const {
+    return auto_gp_from_covariance(covariance, config, strategy);
+  }
+
+  RegressionDataset<double> dataset;
+  decltype(make_simple_covariance_function()) covariance;
+  UniformlySpacedInducingPoints strategy;
+  std::vector<double> test_features;
+};
+
+TEST_F(AutoGPTest, test_plan) {
+  const auto model = make_model(unlimited_auto_gp_config());
+  const auto plan = model.plan(dataset.features);
+
+  EXPECT_EQ(plan.engine, AUTO_GP_ENGINE_EXACT);
+  EXPECT_TRUE(plan.within_budget);
+  EXPECT_EQ(plan.num_features, dataset.size());
+  EXPECT_EQ(plan.feature_dimension, 1);
+  EXPECT_EQ(plan.num_patches, 4);
+  EXPECT_EQ(plan.max_patch_size, 50);
+  EXPECT_EQ(plan.num_boundary_features, 3);
+  EXPECT_EQ(plan.num_inducing_points, 10);
+
+  // Splitting up the problem should always be cheaper.
+  EXPECT_LT(plan.patchwork.memory_bytes, plan.exact.memory_bytes);
+  EXPECT_LT(plan.sparse.memory_bytes, plan.patchwork.memory_bytes);
+  EXPECT_LT(plan.patchwork.seconds, plan.exact.seconds);
+  EXPECT_LT(plan.sparse.seconds, plan.exact.seconds);
+
+  auto recorded = make_model(unlimited_auto_gp_config());
+  recorded.record_plan_insights(dataset.features);
+  EXPECT_EQ(recorded.insights, plan.insights());
+  EXPECT_EQ(recorded.insights.at("engine"), "exact");
+  EXPECT_EQ(recorded.insights.at("num_patches"), "4");
+}
+
+TEST_F(AutoGPTest, test_chooses_exact) {
+  const auto model = make_model(unlimited_auto_gp_config());
+  const auto fit_model = model.fit(dataset);
+
+  EXPECT_EQ(fit_model.get_fit().plan.engine, AUTO_GP_ENGINE_EXACT);
+  EXPECT_EQ(chosen_model_insights(fit_model).at("engine"), "exact");
+
+  const auto direct = gp_from_covariance(covariance);
+  const auto expected = direct.fit(dataset).predict(test_features).joint();
+  const auto actual = fit_model.predict(test_features).joint();
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-8);
+  EXPECT_LT((expected.covariance - actual.covariance).norm(), 1e-8);
+}
+
+TEST_F(AutoGPTest, test_falls_back_to_patchwork) {
+  auto config = unlimited_auto_gp_config();
+  const auto plan = make_model(config).plan(dataset.features);
+
+  config.memory_budget_bytes = static_cast<std::size_t>(
+      0.5 * (plan.exact.memory_bytes + plan.patchwork.memory_bytes));
+  const auto model = make_model(config);
+  const auto fit_model = model.fit(dataset);
+
+  EXPECT_EQ(fit_model.get_fit().plan.engine, AUTO_GP_ENGINE_PATCHWORK);
+  EXPECT_TRUE(fit_model.get_fit().plan.within_budget);
+  EXPECT_EQ(chosen_model_insights(fit_model).at("engine"), "patchwork");
+
+  const auto patchwork = patchwork_gp_from_covariance(
+      covariance, kd_partition_patchwork_functions(
+                      dataset.features, config.max_patch_size,
+                      config.boundary_spacing));
+  const auto expected =
+      patchwork.fit(dataset).predict(test_features).marginal();
+  const auto actual = fit_model.predict(test_features).marginal();
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-8);
+  EXPECT_LT((expected.covariance.diagonal() - actual.covariance.diagonal())
+                .norm(),
+            1e-8);
+}
+
+TEST_F(AutoGPTest, test_falls_back_to_sparse) {
+  auto config = unlimited_auto_gp_config();
+  const auto plan = make_model(config).plan(dataset.features);
+
+  config.memory_budget_bytes = static_cast<std::size_t>(
+      0.5 * (plan.patchwork.memory_bytes + plan.sparse.memory_bytes));
+  const auto model = make_model(config);
+  const auto fit_model = model.fit(dataset);
+
+  EXPECT_EQ(fit_model.get_fit().plan.engine, AUTO_GP_ENGINE_SPARSE);
+  EXPECT_EQ(chosen_model_insights(fit_model).at("engine"), "sparse");
+
+  const KDPartitionGrouper<double> grouper(kd_partition_patchwork_functions(
+      dataset.features, config.max_patch_size, config.boundary_spacing));
+  const auto sparse =
+      sparse_gp_from_covariance(covariance, grouper, strategy, "sparse");
+  const auto expected = sparse.fit(dataset).predict(test_features).joint();
+  const auto actual = fit_model.predict(test_features).joint();
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-8);
+  EXPECT_LT((expected.covariance - actual.covariance).norm(), 1e-8);
+}
+
+TEST_F(AutoGPTest, test_over_budget) {
+  auto config = unlimited_auto_gp_config();
+  const auto plan = make_model(config).plan(dataset.features);
+
+  // Nothing fits, the memory budget is the binding constraint so the
+  // engine with the smallest memory footprint should be used.
+  config.memory_budget_bytes =
+      static_cast<std::size_t>(0.5 * plan.sparse.memory_bytes);
+  const auto over_budget = make_model(config).plan(dataset.features);
+  EXPECT_FALSE(over_budget.within_budget);
+  EXPECT_EQ(over_budget.engine, AUTO_GP_ENGINE_SPARSE);
+  EXPECT_EQ(over_budget.insights().at("within_budget"), "false");
+
+  // A tight latency target alone should also push the model away from
+  // the exact solution.
+  config = unlimited_auto_gp_config();
+  config.latency_target_seconds = 0.5 * plan.exact.seconds;
+  const auto fast = make_model(config).plan(dataset.features);
+  EXPECT_NE(fast.engine, AUTO_GP_ENGINE_EXACT);
+  EXPECT_LE(fast.chosen().seconds, config.latency_target_seconds);
+}
+
+} // namespace albatross
@@ -122,6 +122,44 @@ TEST(test_block_utils, test_sqrt_methods) {
   EXPECT_LE((block_result - dense_result).norm(), 1e-6);
 }
 
+struct ExampleBlockSolver {
+  Eigen::MatrixXd solve(const Eigen::MatrixXd &x) const {
+    return ldlt.solve(x);
+  }
+
+  Eigen::LDLT<Eigen::MatrixXd> ldlt;
+};
+
+TEST(test_block_utils, test_async_block_operations) {
+  Grouped<int, Eigen::MatrixXd> lhs;
+  Grouped<int, Eigen::MatrixXd> rhs;
+  Grouped<int, ExampleBlockSolver> solvers;
+  for (int i = 0; i < 11; ++i) {
+    Eigen::MatrixXd m = Eigen::MatrixXd::Random(4, 4);
+    m = m.transpose() * m + Eigen::MatrixXd::Identity(4, 4);
+    solvers.emplace(i, ExampleBlockSolver{m.ldlt()});
+    lhs.emplace(i, Eigen::MatrixXd::Random(4, 3));
+    rhs.emplace(i, Eigen::MatrixXd::Random(4, 2));
+  }
+
+  const auto original = get_tuning_parameters();
+  TuningParameters params(original);
+  params.threads = 3;
+  set_tuning_parameters(params);
+
+  EXPECT_LT((async_block_sum(lhs) - block_sum(lhs)).norm(), 1e-12);
+  EXPECT_LT((async_block_inner_product(lhs, rhs) -
+             block_inner_product(lhs, rhs))
+                .norm(),
+            1e-12);
+
+  const auto expected_solve = block_diag_solve(solvers, rhs);
+  const auto actual_solve = async_block_diag_solve(solvers, rhs);
+  EXPECT_EQ(expected_solve, actual_solve);
+
+  set_tuning_parameters(original);
+}
+
 TEST(test_block_utils, test_block_symmetric) {
 
   std::default_random_engine gen(2012);
@@ -11,6 +11,7 @@
  */
 
 #include <albatross/Evaluation>
+#include <albatross/utils/ProcessUtils>
 #include <chrono>
 #include <gtest/gtest.h>
 
@@ -121,13 +122,60 @@ TYPED_TEST_P(RegressionModelTester, test_score_variants) {
   }
 }
 
+TYPED_TEST_P(RegressionModelTester, test_streaming_scores) {
+  auto dataset = this->test_case.get_dataset();
+  auto model = this->test_case.get_model();
+
+  LeaveOneOutGrouper leave_one_out;
+  const RootMeanSquareError rmse;
+
+  const Eigen::VectorXd cv_scores =
+      model.cross_validate().scores(rmse, dataset, leave_one_out);
+
+  const auto stats = model.cross_validate().streaming_scores(
+      rmse, dataset, leave_one_out, RunningStatsReducer());
+  EXPECT_EQ(stats.count, dataset.size());
+  EXPECT_NEAR(stats.sum, cv_scores.sum(), 1e-8);
+  EXPECT_NEAR(stats.mean(), cv_scores.mean(), 1e-8);
+  EXPECT_NEAR(stats.variance(), standard_deviation(cv_scores) *
+                                    standard_deviation(cv_scores),
+              1e-8);
+
+  const std::vector<double> edges = {0., 0.05, 0.1, 1.};
+  const auto combined = model.cross_validate().streaming_scores(
+      rmse, dataset, leave_one_out,
+      combine_reducers(RunningStatsReducer(), HistogramReducer(edges)));
+  const auto &histogram = std::get<1>(combined.reducers);
+  std::size_t total = histogram.below + histogram.above;
+  for (const auto &count : histogram.counts) {
+    total += count;
+  }
+  EXPECT_EQ(total, dataset.size());
+  EXPECT_EQ(std::get<0>(combined.reducers).count, dataset.size());
+}
+
 REGISTER_TYPED_TEST_CASE_P(RegressionModelTester, test_loo_predict_variants,
                            test_logo_predict_variants, test_loo_get_predictions,
-                           test_score_variants);
+                           test_score_variants, test_streaming_scores);
 
 INSTANTIATE_TYPED_TEST_CASE_P(test_cross_validation, RegressionModelTester,
                               ExampleModels);
 
+TEST(test_crossvalidation, test_process_scores) {
+  const auto dataset = make_toy_linear_data();
+  auto model = MakeGaussianProcess().get_model();
+
+  auto group = [](const double &x) { return lround(x / 3.); };
+  const RootMeanSquareError rmse;
+
+  const Eigen::VectorXd expected =
+      model.cross_validate().scores(rmse, dataset, group);
+  const Eigen::VectorXd actual =
+      model.cross_validate().process_scores(rmse, dataset, group, 2);
+
+  EXPECT_LT((expected - actual).norm(), 1e-10);
+}
+
 /*
  * Here we build two different datasets.  Each dataset consists of targets
  * which have been distorted by non-constant noise (heteroscedastic), we then
@@ -217,4 +265,60 @@ TYPED_TEST(SpecializedCrossValidationTester,
   EXPECT_NEAR((cv_fast_scores - cv_slow_scores).norm(), 0., 1e-8);
 }
 
+TEST(test_cross_validation, test_predictions_reusing_covariance) {
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 30);
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const auto indexer = group_by(dataset, group_by_interval<double>).indexers();
+  const auto cv = model.cross_validate();
+
+  const auto means =
+      cv.predictions_reusing_covariance<Eigen::VectorXd>(dataset, indexer);
+  const auto marginals =
+      cv.predictions_reusing_covariance<MarginalDistribution>(dataset, indexer);
+  const auto joints =
+      cv.predictions_reusing_covariance<JointDistribution>(dataset, indexer);
+
+  // These should be identical to refitting the model for each fold.
+  const auto folds = folds_from_group_indexer(dataset, indexer);
+  EXPECT_EQ(joints.size(), folds.size());
+  for (const auto &pair : folds) {
+    const auto expected = predict_fold(model, pair.second).joint();
+    EXPECT_LT((means.at(pair.first) - expected.mean).norm(), 1e-6);
+    EXPECT_LT((marginals.at(pair.first).mean - expected.mean).norm(), 1e-6);
+    EXPECT_LT((marginals.at(pair.first).covariance.diagonal() -
+               expected.covariance.diagonal())
+                  .norm(),
+              1e-6);
+    EXPECT_LT((joints.at(pair.first).covariance - expected.covariance).norm(),
+              1e-6);
+  }
+
+  const RootMeanSquareError rmse;
+  const Eigen::VectorXd scores = cv.scores(rmse, dataset, indexer);
+  const Eigen::VectorXd reused_scores =
+      cv.scores_reusing_covariance(rmse, dataset, group_by_interval<double>);
+  EXPECT_LT((scores - reused_scores).norm(), 1e-6);
+}
+
+TEST(test_cross_validation, test_dataset_covariance_measurement_terms) {
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 30);
+
+  // The training covariance is only assembled separately if the model
+  // has terms which only apply to measurements.
+  const auto with_noise = gp_from_covariance(make_simple_covariance_function());
+  const auto noisy =
+      details::gp_dataset_covariance(with_noise, dataset.features);
+  EXPECT_GT(noisy.measurement.size(), 0);
+  EXPECT_GT((noisy.train() - noisy.prior).norm(), 0.);
+
+  const SquaredExponential<EuclideanDistance> squared_exponential(100., 100.);
+  const auto without_noise = gp_from_covariance(squared_exponential);
+  const auto noiseless =
+      details::gp_dataset_covariance(without_noise, dataset.features);
+  EXPECT_EQ(noiseless.measurement.size(), 0);
+  EXPECT_EQ(noiseless.train(), without_noise.compute_covariance(
+                                   as_measurements(dataset.features)));
+}
+
 } // namespace albatross
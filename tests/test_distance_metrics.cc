@@ -85,4 +85,46 @@ TEST(test_distance_metrics, test_distance_matrix) {
   EXPECT_EQ(dist_matrix.cols(), points.size());
 }
 
+TEST(test_distance_metrics, test_coordinate_views) {
+
+  const auto points = random_spherical_points(10);
+  const Eigen::Index n = static_cast<Eigen::Index>(points.size());
+
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> row_major(n, 3);
+  Eigen::MatrixXd col_major(n, 3);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    row_major.row(i) = points[static_cast<std::size_t>(i)];
+    col_major.row(i) = points[static_cast<std::size_t>(i)];
+  }
+
+  const auto row_views = coordinate_views(row_major);
+  const auto col_views = coordinate_views(col_major);
+  // Every other point from the row major buffer.
+  const auto strided_views =
+      coordinate_views(row_major.data(), points.size() / 2, 3, 6);
+  ASSERT_EQ(row_views.size(), points.size());
+  ASSERT_EQ(col_views.size(), points.size());
+  EXPECT_EQ(row_views[0].data, row_major.data());
+
+  EuclideanDistance euclidean;
+  RadialDistance radial;
+  AngularDistance angular;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(row_views[i], col_views[i]);
+    EXPECT_EQ(Eigen::VectorXd(col_views[i].vector()), points[i]);
+    for (std::size_t j = 0; j < points.size(); ++j) {
+      EXPECT_DOUBLE_EQ(euclidean(row_views[i], col_views[j]),
+                       euclidean(points[i], points[j]));
+      EXPECT_DOUBLE_EQ(radial(row_views[i], col_views[j]),
+                       radial(points[i], points[j]));
+      EXPECT_DOUBLE_EQ(angular(row_views[i], col_views[j]),
+                       angular(points[i], points[j]));
+    }
+  }
+
+  for (std::size_t i = 0; i < strided_views.size(); ++i) {
+    EXPECT_EQ(strided_views[i], row_views[2 * i]);
+  }
+}
+
 } // namespace albatross
@@ -154,6 +154,59 @@ auto test_unobservable_model() {
   return model;
 }
 
+TEST(test_gp, test_grouped_joint) {
+  const auto dataset = make_toy_linear_data();
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+  const auto fit_model = model.fit(dataset);
+
+  const auto test_features = linspace(-3., 13., 17);
+  const auto grouper = [](const double &x) { return std::lround(x) % 3; };
+  expect_grouped_joint_matches_joint(fit_model.predict(test_features),
+                                     test_features, grouper);
+
+  // Many more groups than there are threads.
+  const auto many_features = linspace(-3., 13., 2000);
+  const auto leave_one_out = [](const double &x) { return x; };
+  expect_grouped_joint_matches_joint(fit_model.predict(many_features),
+                                     many_features, leave_one_out);
+}
+
+TEST(test_gp, test_fit_coordinate_views) {
+  const auto points = random_spherical_points(20);
+  const Eigen::Index n = static_cast<Eigen::Index>(points.size());
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> coordinates(n, 3);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    coordinates.row(i) = points[static_cast<std::size_t>(i)];
+  }
+  Eigen::VectorXd mean = coordinates.col(0) + 2. * coordinates.col(2);
+  Eigen::VectorXd variance = Eigen::VectorXd::Constant(n, 0.01);
+
+  const auto model =
+      gp_from_covariance(SquaredExponential<EuclideanDistance>(1., 1.));
+  const auto views = coordinate_views(coordinates);
+  const auto view_fit = model.fit(views, mean, variance);
+  const auto expected_fit =
+      model.fit(points, MarginalDistribution(mean, variance));
+
+  const auto view_pred = view_fit.predict(views).joint();
+  const auto expected_pred = expected_fit.predict(points).joint();
+  EXPECT_LT((view_pred.mean - expected_pred.mean).norm(), 1e-10);
+  EXPECT_LT((view_pred.covariance - expected_pred.covariance).norm(), 1e-10);
+}
+
+TEST(test_gp, test_fit_caller_buffers_with_mean) {
+  MakeGaussianProcessWithMean case_;
+  const auto model = case_.get_model();
+  const auto dataset = case_.get_dataset();
+  const Eigen::VectorXd mean = dataset.targets.mean;
+  const Eigen::VectorXd variance = dataset.targets.covariance.diagonal();
+
+  // The mean function is removed from the fit's own copy of the targets.
+  const auto buffer_fit = model.fit(dataset.features, mean, variance);
+  EXPECT_EQ(mean, dataset.targets.mean);
+  EXPECT_EQ(buffer_fit.get_fit(), model.fit(dataset).get_fit());
+}
+
 TEST(test_gp, test_update_model_trait) {
   const auto dataset = test_unobservable_dataset();
 
@@ -214,6 +267,68 @@ TEST(test_gp, test_update_model_same_types) {
   EXPECT_GE((split_pred.covariance - first_pred.covariance).norm(), 1e-6);
 }
 
+TEST(test_gp, test_update_with_fit_deltas) {
+  auto dataset = make_toy_linear_data();
+  dataset.targets.covariance =
+      0.01 * Eigen::VectorXd::Ones(dataset.size()).asDiagonal();
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const std::vector<std::size_t> first_inds = {0, 1, 2, 3};
+  const std::vector<std::size_t> second_inds = {4, 5, 6};
+  const std::vector<std::size_t> third_inds = {7, 8, 9};
+  const auto first = albatross::subset(dataset, first_inds);
+  const auto second = albatross::subset(dataset, second_inds);
+  const auto third = albatross::subset(dataset, third_inds);
+
+  const auto first_fit = model.fit(first).get_fit();
+
+  // Updating an appendable fit keeps the same type ...
+  const auto appendable = as_appendable_fit(first_fit);
+  const auto second_fit =
+      model._update_impl(appendable, second.features, second.targets);
+  const auto third_fit =
+      model._update_impl(second_fit, third.features, third.targets);
+  bool same_type =
+      std::is_same<decltype(appendable), decltype(third_fit)>::value;
+  EXPECT_TRUE(same_type);
+
+  // ... and represents the same system as the nested BlockSymmetric updates.
+  const auto nested_model = update(update(model.fit(first), second), third);
+  const auto nested = nested_model.get_fit();
+  EXPECT_EQ(third_fit.train_features, nested.train_features);
+  EXPECT_LE((third_fit.information - nested.information).norm(),
+            1e-8 * nested.information.norm());
+  const Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(10, 10);
+  const Eigen::MatrixXd nested_inverse =
+      nested.train_covariance.solve(identity);
+  EXPECT_LE(
+      (third_fit.train_covariance.solve(identity) - nested_inverse).norm(),
+      1e-8 * nested_inverse.norm());
+
+  // Replaying the deltas on the original fit reproduces the update exactly.
+  auto replayed = as_appendable_fit(first_fit);
+  apply_fit_delta(
+      model.update_delta(replayed, second.features, second.targets),
+      &replayed);
+  EXPECT_EQ(replayed, second_fit);
+  apply_fit_delta(
+      model.update_delta(replayed, third.features, third.targets), &replayed);
+  EXPECT_EQ(replayed, third_fit);
+
+  // Compacting gives a regular fit which represents the same system.
+  const auto compacted = compact_fit(third_fit);
+  EXPECT_EQ(compacted.train_features, third_fit.train_features);
+  EXPECT_EQ(compacted.information, third_fit.information);
+  const Eigen::MatrixXd covariance =
+      third_fit.train_covariance.reconstructedMatrix();
+  EXPECT_LE((compacted.train_covariance.reconstructedMatrix() - covariance)
+                .norm(),
+            1e-8 * covariance.norm());
+  EXPECT_LE((compacted.train_covariance.solve(identity) - nested_inverse)
+                .norm(),
+            1e-6 * nested_inverse.norm());
+}
+
 TEST(test_gp, test_update_model_different_types) {
   const auto dataset = test_unobservable_dataset();
 
@@ -574,4 +574,58 @@ TEST(test_groupby, test_group_by_any_all) {
   EXPECT_FALSE(grouped.apply(greater_than_max_count).any());
 }
 
+TEST(test_groupby, test_group_by_rvalue_chain) {
+
+  const auto fib = fibonacci(20);
+
+  auto is_odd = [](const double &x) { return std::fmod(x, 2.) == 1.; };
+  auto only_odd = [&](const std::vector<double> &xs) {
+    return filter(xs, is_odd);
+  };
+  auto not_empty = [](const std::vector<double> &xs) { return !xs.empty(); };
+
+  const auto grouped = group_by(fib, number_of_digits);
+  const auto expected = grouped.apply(only_odd).filter(not_empty).combine();
+
+  // Each step operates on a temporary so the groups are moved through
+  // the chain instead of copied.
+  const auto actual = group_by(std::vector<double>(fib), number_of_digits)
+                          .groups()
+                          .apply(only_odd)
+                          .filter(not_empty)
+                          .combine();
+
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(test_groupby, test_group_by_apply_in_place) {
+
+  const auto fib = fibonacci(20);
+
+  auto groups = group_by(fib, number_of_digits).groups();
+  const auto num_groups = groups.size();
+
+  const auto *map_address = &groups.get_map();
+  groups.apply_in_place([](std::vector<double> &xs) { xs.resize(1); });
+  EXPECT_EQ(map_address, &groups.get_map());
+
+  for (const auto &pair : groups) {
+    EXPECT_EQ(pair.second.size(), 1);
+  }
+  EXPECT_EQ(groups.size(), num_groups);
+}
+
+TEST(test_groupby, test_group_by_combine_rvalue_dataset) {
+
+  const auto dataset = test_integer_dataset();
+
+  const auto expected = dataset.group_by(above_three).groups().combine();
+
+  auto groups = dataset.group_by(above_three).groups();
+  const auto actual = std::move(groups).combine();
+
+  EXPECT_EQ(expected, actual);
+  expect_same_but_maybe_out_of_order(actual, dataset);
+}
+
 } // namespace albatross
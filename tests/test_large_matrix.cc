@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <albatross/GP>
+
+#include "test_utils.h"
+
+namespace albatross {
+
+TEST(test_large_matrix, test_column_blocks) {
+  const auto blocks = large_matrix_column_blocks(10, 4);
+  ASSERT_EQ(blocks.size(), 4);
+
+  Eigen::Index expected_first = 0;
+  for (const auto &block : blocks) {
+    EXPECT_EQ(block.first, expected_first);
+    EXPECT_GE(block.second, 2);
+    EXPECT_LE(block.second, 3);
+    expected_first += block.second;
+  }
+  EXPECT_EQ(expected_first, 10);
+
+  EXPECT_EQ(large_matrix_column_blocks(2, 4).size(), 2);
+  EXPECT_EQ(large_matrix_column_blocks(0, 4).size(), 0);
+}
+
+TEST(test_large_matrix, test_allocate) {
+  LargeMatrixPolicy policy;
+  policy.min_bytes = 0;
+
+  // The buffer is left uninitialized for the parallel writers.
+  Eigen::MatrixXd x = allocate_large_matrix(20, 7, policy);
+  EXPECT_EQ(x.rows(), 20);
+  EXPECT_EQ(x.cols(), 7);
+  x.setOnes();
+  EXPECT_EQ(x, Eigen::MatrixXd::Ones(20, 7));
+}
+
+TEST(test_large_matrix, test_policy_does_not_change_fit) {
+  const auto dataset = make_toy_linear_data();
+  const auto model =
+      gp_from_covariance(SquaredExponential<EuclideanDistance>(10., 1.));
+
+  const auto expected = model.fit(dataset).predict(dataset.features).joint();
+
+  const auto original_policy = get_large_matrix_policy();
+  LargeMatrixPolicy policy;
+  policy.min_bytes = 0;
+  policy.huge_pages = false;
+  set_large_matrix_policy(policy);
+  const auto actual = model.fit(dataset).predict(dataset.features).joint();
+  set_large_matrix_policy(original_policy);
+
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(test_large_matrix, test_policy_concurrent_access) {
+  const auto original_policy = get_large_matrix_policy();
+  LargeMatrixPolicy initial_policy;
+  initial_policy.min_bytes = 0;
+  initial_policy.huge_pages = true;
+  set_large_matrix_policy(initial_policy);
+
+  // Readers should always see one of the policies which were set as a
+  // whole, never a mix of two.
+  std::atomic<bool> consistent(true);
+  std::vector<std::thread> readers;
+  for (std::size_t i = 0; i < 4; ++i) {
+    readers.emplace_back([&consistent]() {
+      for (std::size_t j = 0; j < 1000; ++j) {
+        const auto policy = get_large_matrix_policy();
+        if (policy.huge_pages != (policy.min_bytes % 2 == 0)) {
+          consistent = false;
+        }
+      }
+    });
+  }
+  for (std::size_t i = 0; i < 100; ++i) {
+    LargeMatrixPolicy policy;
+    policy.min_bytes = i;
+    policy.huge_pages = i % 2 == 0;
+    set_large_matrix_policy(policy);
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_TRUE(consistent);
+
+  set_large_matrix_policy(original_policy);
+}
+
+} // namespace albatross
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "test_models.h"
+
+#include <albatross/utils/MappedFit>
+
+namespace albatross {
+
+inline std::string mapped_fit_test_path(const std::string &name) {
+  return "albatross_test_" + name + "_" + std::to_string(getpid()) + ".fit";
+}
+
+TEST(test_mapped_fit, test_writer_alignment) {
+  const std::string path = mapped_fit_test_path("alignment");
+
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(7, 0., 1.);
+  const Eigen::MatrixXd y = Eigen::MatrixXd::Random(3, 5);
+  const std::vector<int> z = {1, 2, 3};
+
+  MappedFitWriter writer;
+  writer.add("x", x);
+  writer.add("y", y);
+  writer.add("z", z);
+  writer.write(path);
+
+  {
+    const MappedFitFile file(path);
+    EXPECT_TRUE(file.contains("y"));
+    EXPECT_FALSE(file.contains("w"));
+    EXPECT_EQ(file.vector("x"), x);
+    EXPECT_EQ(file.matrix("y"), y);
+    EXPECT_EQ(file.size("z"), z.size());
+    EXPECT_EQ(std::vector<int>(file.data<int>("z"), file.data<int>("z") + 3),
+              z);
+
+    for (const auto &name : {"x", "y"}) {
+      const auto address =
+          reinterpret_cast<std::uintptr_t>(file.matrix(name).data());
+      EXPECT_EQ(address % 4096, 0);
+    }
+
+    // Arrays are checked against the type they're read as.
+    EXPECT_THROW(file.data<int>("x"), std::runtime_error);
+    EXPECT_THROW(file.vector("w"), std::runtime_error);
+  }
+
+  std::remove(path.c_str());
+  EXPECT_THROW(MappedFitFile{path}, std::runtime_error);
+
+  std::ofstream(path) << "definitely not a fit";
+  EXPECT_THROW(MappedFitFile{path}, std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(test_mapped_fit, test_gp_fit_round_trip) {
+  const std::string path = mapped_fit_test_path("gp");
+
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 50);
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+  const auto fit_model = model.fit(dataset);
+
+  save_mapped_gp_fit(path, fit_model.get_fit());
+  const auto mapped = load_mapped_gp_fit_model<double>(model, path);
+  // The mapping outlives the file name.
+  std::remove(path.c_str());
+
+  const auto &fit = fit_model.get_fit();
+  const auto mapped_fit = mapped.get_fit();
+  EXPECT_EQ(mapped_fit.train_features, fit.train_features);
+  EXPECT_EQ(mapped_fit.information, fit.information);
+  EXPECT_EQ(mapped_fit.train_covariance.rows(), fit.train_covariance.rows());
+  EXPECT_EQ(mapped_fit.train_covariance.matrixLDLT(),
+            fit.train_covariance.matrixLDLT());
+  EXPECT_DOUBLE_EQ(mapped_fit.train_covariance.log_determinant(),
+                   fit.train_covariance.log_determinant());
+
+  const Eigen::MatrixXd rhs = Eigen::MatrixXd::Random(50, 3);
+  EXPECT_EQ(mapped_fit.train_covariance.solve(rhs),
+            fit.train_covariance.solve(rhs));
+
+  const auto test_features = linspace(-5., 55., 13);
+  const auto expected = fit_model.predict(test_features).joint();
+  const auto actual = mapped.predict(test_features).joint();
+  EXPECT_EQ(actual.mean, expected.mean);
+  EXPECT_EQ(actual.covariance, expected.covariance);
+
+  const auto marginal = mapped.predict(test_features).marginal();
+  EXPECT_EQ(marginal.mean, expected.mean);
+  EXPECT_LT((marginal.covariance.diagonal() - expected.covariance.diagonal())
+                .norm(),
+            1e-10);
+}
+
+} // namespace albatross
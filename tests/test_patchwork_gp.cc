@@ -17,6 +17,8 @@
 #include <fstream>
 
 #include <albatross/PatchworkGP>
+#include <albatross/serialize/GP>
+#include <albatross/utils/ProcessUtils>
 #include <albatross/utils/CsvUtils>
 
 namespace albatross {
@@ -105,6 +107,40 @@ void expect_patchwork_gp_performance(
   EXPECT_LT(patchwork_cov_diff, cov_threshold);
 }
 
+/*
+ * Directly forms the covariance of the constrained model,
+ *
+ *   K = C_dd - C_db C_bb^-1 C_bd
+ *
+ * in the same order as the (training) features.
+ */
+template <typename CovFunc, typename BoundaryFeatureType>
+Eigen::MatrixXd dense_patchwork_covariance(
+    const CovFunc &covariance,
+    const ExamplePatchworkFunctions &patchwork_functions,
+    const std::vector<double> &features,
+    const std::vector<BoundaryFeatureType> &boundary_features) {
+  auto grouper = [&](const auto &f) { return patchwork_functions.grouper(f); };
+  const auto group_features = as_group_features(features, grouper);
+  std::vector<GroupFeature<long int, Measurement<double>>>
+      measurement_features;
+  for (const auto &f : group_features) {
+    measurement_features.emplace_back(f.group_key,
+                                      Measurement<double>(f.feature));
+  }
+
+  auto caller = [&](const auto &x, const auto &y) {
+    return PatchworkCaller::call(covariance, x, y);
+  };
+  const Eigen::MatrixXd C_dd = compute_covariance_matrix(
+      caller, measurement_features, measurement_features);
+  const Eigen::MatrixXd C_db =
+      compute_covariance_matrix(caller, group_features, boundary_features);
+  const Eigen::MatrixXd C_bb =
+      compute_covariance_matrix(caller, boundary_features, boundary_features);
+  return C_dd - C_db * C_bb.ldlt().solve(C_db.transpose());
+}
+
 TEST(test_patchwork_gp, test_traits) {
 
   struct PatchworkTestType {};
@@ -133,6 +169,52 @@ TEST(test_patchwork_gp, test_sanity) {
   expect_patchwork_gp_performance(covariance, patchwork_functions, 5e-2, 0.3);
 }
 
+TEST(test_patchwork_gp, test_fit_with_processes) {
+
+  const auto dataset = shuffle_dataset(make_toy_linear_data());
+  const auto patchwork = patchwork_gp_from_covariance(
+      make_simple_covariance_function(), ExamplePatchworkFunctions());
+
+  const auto test_features = linspace(0.01, 9.9, 11);
+  const auto expected = patchwork.fit(dataset).predict(test_features).joint();
+  const auto actual = patchwork.fit_with_processes(dataset, 2)
+                          .predict(test_features)
+                          .joint();
+
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-10);
+  EXPECT_LT((expected.covariance - actual.covariance).norm(), 1e-10);
+}
+
+TEST(test_patchwork_gp, test_async_matches_serial) {
+
+  const auto dataset = shuffle_dataset(make_toy_linear_data());
+  auto patchwork = patchwork_gp_from_covariance(
+      make_simple_covariance_function(), ExamplePatchworkFunctions(2.));
+
+  const auto test_features = linspace(0.01, 9.9, 11);
+  const auto expected = patchwork.fit(dataset).predict(test_features).joint();
+
+  const auto original = get_tuning_parameters();
+  TuningParameters params(original);
+  params.threads = 3;
+  set_tuning_parameters(params);
+  patchwork.set_async_flag(true);
+  const auto actual = patchwork.fit(dataset).predict(test_features).joint();
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-10);
+  EXPECT_LT((expected.covariance - actual.covariance).norm(), 1e-10);
+
+  // In deterministic mode the thread count has no effect at all.
+  set_deterministic_execution(true);
+  const auto deterministic =
+      patchwork.fit(dataset).predict(test_features).joint();
+  params.threads = 1;
+  set_tuning_parameters(params);
+  EXPECT_EQ(patchwork.fit(dataset).predict(test_features).joint(),
+            deterministic);
+  set_deterministic_execution(false);
+  set_tuning_parameters(original);
+}
+
 TEST(test_patchwork_gp, test_one_group) {
 
   auto covariance = make_simple_covariance_function();
@@ -174,4 +256,246 @@ TEST(test_patchwork_gp, test_scales) {
   EXPECT_LT(patchwork_duration, 0.3 * direct_duration);
 }
 
+TEST(test_patchwork_gp, test_log_likelihood) {
+
+  const ExamplePatchworkFunctions patchwork_functions;
+
+  auto covariance = make_simple_covariance_function();
+  covariance.set_param("squared_exponential_length_scale", 10.);
+
+  const auto dataset = shuffle_dataset(make_toy_linear_data());
+
+  const auto patchwork =
+      patchwork_gp_from_covariance(covariance, patchwork_functions);
+  const auto patchwork_fit = patchwork.fit(dataset).get_fit();
+  ASSERT_GT(patchwork_fit.fit_models.size(), 1);
+
+  // Directly form the covariance of the constrained model which the
+  // patchwork log likelihood should avoid.
+  const Eigen::MatrixXd K = dense_patchwork_covariance(
+      covariance, patchwork_functions, dataset.features,
+      patchwork_fit.boundary_features);
+
+  const double expected = -negative_log_likelihood(dataset.targets.mean, K);
+  EXPECT_NEAR(patchwork.log_likelihood(dataset), expected,
+              1e-6 * fabs(expected));
+
+  auto async_patchwork = patchwork;
+  async_patchwork.set_async_flag(true);
+  EXPECT_DOUBLE_EQ(async_patchwork.log_likelihood(dataset),
+                   patchwork.log_likelihood(dataset));
+
+  // With a single group the patchwork model is a Gaussian process.
+  const ExamplePatchworkFunctions one_group_functions(1000.);
+  const auto one_group =
+      patchwork_gp_from_covariance(covariance, one_group_functions);
+  const auto direct = gp_from_covariance(covariance);
+  EXPECT_NEAR(one_group.log_likelihood(dataset), direct.log_likelihood(dataset),
+              1e-8);
+}
+
+TEST(test_patchwork_gp, test_cross_validated_predictions) {
+
+  const ExamplePatchworkFunctions patchwork_functions;
+
+  auto covariance = make_simple_covariance_function();
+  covariance.set_param("squared_exponential_length_scale", 10.);
+
+  const auto dataset = shuffle_dataset(make_toy_linear_data());
+
+  const auto patchwork =
+      patchwork_gp_from_covariance(covariance, patchwork_functions);
+  using PatchworkType = typename std::decay<decltype(patchwork)>::type;
+  EXPECT_TRUE(bool(has_valid_cv_joint<PatchworkType, double, long int>::value));
+
+  const auto patchwork_fit = patchwork.fit(dataset).get_fit();
+  ASSERT_GT(patchwork_fit.fit_models.size(), 1);
+
+  const Eigen::MatrixXd K = dense_patchwork_covariance(
+      covariance, patchwork_functions, dataset.features,
+      patchwork_fit.boundary_features);
+  const Eigen::VectorXd &y = dataset.targets.mean;
+
+  // Compares against explicitly conditioning on all the other groups
+  // under the patchwork covariance.
+  auto expect_matches_dense = [&](const auto &indexer) {
+    const auto cv = patchwork.cross_validate();
+    const auto joints = cv.predict(dataset, indexer).joints();
+    const auto marginals = cv.predict(dataset, indexer).marginals();
+    const auto means = cv.predict(dataset, indexer).means();
+
+    for (const auto &pair : indexer) {
+      const auto &test_indices = pair.second;
+      const auto train_indices =
+          indices_complement(test_indices, dataset.size());
+
+      const Eigen::MatrixXd K_tt = subset(K, test_indices, test_indices);
+      const Eigen::MatrixXd K_tr = subset(K, test_indices, train_indices);
+      const Eigen::MatrixXd K_rr = subset(K, train_indices, train_indices);
+      const Eigen::VectorXd y_r = subset(y, train_indices);
+
+      const auto K_rr_ldlt = K_rr.ldlt();
+      const Eigen::VectorXd mean = K_tr * K_rr_ldlt.solve(y_r);
+      const Eigen::MatrixXd cov =
+          K_tt - K_tr * K_rr_ldlt.solve(K_tr.transpose());
+
+      const auto &joint = joints.at(pair.first);
+      EXPECT_LT((joint.mean - mean).norm(), 1e-6);
+      EXPECT_LT((joint.covariance - cov).norm(), 1e-6);
+
+      const auto &marginal = marginals.at(pair.first);
+      EXPECT_LT((marginal.mean - mean).norm(), 1e-6);
+      EXPECT_LT((marginal.covariance.diagonal() - cov.diagonal()).norm(),
+                1e-6);
+
+      EXPECT_LT((means.at(pair.first) - mean).norm(), 1e-6);
+    }
+  };
+
+  auto grouper = [&](const auto &f) { return patchwork_functions.grouper(f); };
+  expect_matches_dense(dataset.group_by(grouper).indexers());
+
+  // Groups which cut across patches.
+  GroupIndexer<std::size_t> odd_even_indexer;
+  for (std::size_t i = 0; i < dataset.size(); ++i) {
+    odd_even_indexer[i % 2].push_back(i);
+  }
+  expect_matches_dense(odd_even_indexer);
+
+  expect_matches_dense(dataset.group_by(LeaveOneOutGrouper()).indexers());
+}
+
+TEST(test_patchwork_gp, test_kd_partition_one_dimension) {
+
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 200);
+
+  const std::size_t max_patch_size = 50;
+  const auto patchwork_functions =
+      kd_partition_patchwork_functions(dataset.features, max_patch_size, 1.);
+  EXPECT_EQ(patchwork_functions.number_of_groups(), 4);
+
+  auto grouper = [&](const auto &f) { return patchwork_functions.grouper(f); };
+  const auto counts = group_by(dataset.features, grouper).counts();
+  for (const auto &pair : counts) {
+    EXPECT_LE(pair.second, max_patch_size);
+  }
+
+  // In one dimension only neighbouring patches share a boundary
+  // which consists of a single point.
+  const auto keys = counts.keys();
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    for (std::size_t j = i + 1; j < keys.size(); ++j) {
+      const auto boundary = patchwork_functions.boundary(keys[i], keys[j]);
+      EXPECT_EQ(boundary.size(), j == i + 1 ? 1 : 0);
+    }
+  }
+
+  const std::vector<std::size_t> available = {keys[0], keys[3]};
+  EXPECT_EQ(patchwork_functions.nearest_group(available, keys[1]), keys[0]);
+  EXPECT_EQ(patchwork_functions.nearest_group(available, keys[2]), keys[3]);
+
+  const auto covariance = make_simple_covariance_function();
+  const auto direct = gp_from_covariance(covariance, "direct");
+  const auto patchwork =
+      patchwork_gp_from_covariance(covariance, patchwork_functions);
+
+  const auto test_features = linspace(0.01, 199., 21);
+  const auto direct_pred = direct.fit(dataset).predict(test_features).mean();
+  const auto patchwork_pred =
+      patchwork.fit(dataset).predict(test_features).mean();
+  EXPECT_LT(root_mean_square_error(patchwork_pred, direct_pred), 5e-2);
+}
+
+TEST(test_patchwork_gp, test_kd_partition_two_dimensions) {
+
+  std::default_random_engine gen(2012);
+  std::uniform_real_distribution<double> dist(0., 10.);
+
+  std::vector<Eigen::VectorXd> features;
+  for (std::size_t i = 0; i < 400; ++i) {
+    Eigen::VectorXd x(2);
+    x << dist(gen), dist(gen);
+    features.emplace_back(x);
+  }
+
+  const std::size_t max_patch_size = 60;
+  const double spacing = 0.5;
+  const auto patchwork_functions =
+      kd_partition_patchwork_functions(features, max_patch_size, spacing);
+  EXPECT_EQ(patchwork_functions.number_of_groups(), 8);
+
+  auto grouper = [&](const auto &f) { return patchwork_functions.grouper(f); };
+  const auto counts = group_by(features, grouper).counts();
+  EXPECT_EQ(counts.size(), 8);
+  for (const auto &pair : counts) {
+    EXPECT_LE(pair.second, max_patch_size);
+    EXPECT_GE(pair.second, max_patch_size / 2);
+  }
+
+  // The patches tile the domain so every patch must share a boundary
+  // with at least one other patch.
+  const auto keys = counts.keys();
+  std::size_t boundary_count = 0;
+  for (const auto &x : keys) {
+    std::size_t neighbours = 0;
+    for (const auto &y : keys) {
+      if (x != y) {
+        const auto boundary = patchwork_functions.boundary(x, y);
+        if (boundary.size() > 0) {
+          ++neighbours;
+          boundary_count += boundary.size();
+        }
+        for (const auto &b : boundary) {
+          EXPECT_EQ(b.size(), 2);
+          EXPECT_GE(b.minCoeff(), 0.);
+          EXPECT_LE(b.maxCoeff(), 10.);
+        }
+      }
+    }
+    EXPECT_GT(neighbours, 0);
+  }
+  EXPECT_GT(boundary_count, 0);
+
+  const std::vector<std::size_t> available(keys.begin() + 1, keys.end());
+  const auto nearest = patchwork_functions.nearest_group(available, keys[0]);
+  EXPECT_NE(nearest, keys[0]);
+}
+
+TEST(test_patchwork_gp, test_kd_partition_repeated_coordinates) {
+
+  // Static sites which are each sampled at the same times produce
+  // many features which share coordinates along every dimension.
+  std::default_random_engine gen(2012);
+  std::uniform_real_distribution<double> dist(0., 10.);
+
+  std::vector<Eigen::VectorXd> sites;
+  for (std::size_t i = 0; i < 5; ++i) {
+    Eigen::VectorXd site(2);
+    site << dist(gen), dist(gen);
+    sites.emplace_back(site);
+  }
+
+  std::vector<Eigen::VectorXd> features;
+  for (std::size_t t = 0; t < 30; ++t) {
+    for (const auto &site : sites) {
+      Eigen::VectorXd x(3);
+      x << site, static_cast<double>(t / 5);
+      features.emplace_back(x);
+    }
+  }
+
+  const std::size_t max_patch_size = 25;
+  const auto patchwork_functions =
+      kd_partition_patchwork_functions(features, max_patch_size, 1.);
+
+  auto grouper = [&](const auto &f) { return patchwork_functions.grouper(f); };
+  const auto counts = group_by(features, grouper).counts();
+  // Every patch in the partition receives at least one feature.
+  EXPECT_EQ(counts.size(), patchwork_functions.number_of_groups());
+  for (const auto &pair : counts) {
+    EXPECT_LE(pair.second, max_patch_size);
+    EXPECT_GT(pair.second, 0);
+  }
+}
+
 } // namespace albatross
@@ -11,6 +11,7 @@
  */
 
 #include <albatross/Core>
+#include <albatross/CovarianceFunctions>
 #include <gtest/gtest.h>
 
 namespace albatross {
@@ -115,4 +116,182 @@ TEST(test_prediction, test_joint_only) {
   EXPECT_TRUE(bool(std::is_same<JointDistribution, decltype(joint)>::value));
 }
 
+class CountingModel;
+
+template <> struct Fit<CountingModel> {
+  double offset = 0.;
+
+  bool operator==(const Fit &other) const { return offset == other.offset; }
+};
+
+class CountingModel : public ModelBase<CountingModel> {
+public:
+  CountingModel() : calls(std::make_shared<std::size_t>(0)){};
+
+  Fit<CountingModel> _fit_impl(const std::vector<double> &,
+                               const MarginalDistribution &targets) const {
+    Fit<CountingModel> fit;
+    fit.offset = targets.mean.mean();
+    return fit;
+  }
+
+  Fit<CountingModel> _update_impl(const Fit<CountingModel> &fit,
+                                  const std::vector<double> &,
+                                  const MarginalDistribution &targets) const {
+    Fit<CountingModel> output(fit);
+    output.offset += targets.mean.mean();
+    return output;
+  }
+
+  JointDistribution
+  _predict_impl(const std::vector<double> &features,
+                const Fit<CountingModel> &fit,
+                PredictTypeIdentity<JointDistribution>) const {
+    ++(*calls);
+    const Eigen::Index n = static_cast<Eigen::Index>(features.size());
+    Eigen::VectorXd mean(n);
+    for (Eigen::Index i = 0; i < n; ++i) {
+      mean[i] = features[static_cast<std::size_t>(i)] + fit.offset;
+    }
+    return JointDistribution(mean, Eigen::MatrixXd::Identity(n, n));
+  }
+
+  std::shared_ptr<std::size_t> calls;
+};
+
+TEST(test_prediction, test_prediction_cache) {
+  CountingModel m;
+  const std::vector<double> xs = {0., 1., 2.};
+  const std::vector<double> ys = {3., 4.};
+  MarginalDistribution targets(Eigen::VectorXd::Ones(3));
+
+  auto fit_model = m.fit(xs, targets);
+
+  // Disabled by default.
+  fit_model.predict(xs).mean();
+  fit_model.predict(xs).mean();
+  EXPECT_EQ(*m.calls, 2);
+  EXPECT_EQ(fit_model.prediction_cache_stats().hits, 0);
+  EXPECT_EQ(fit_model.prediction_cache_stats().misses, 0);
+
+  fit_model.enable_prediction_cache(2);
+  const Eigen::VectorXd expected = fit_model.predict(xs).mean();
+  EXPECT_EQ(*m.calls, 3);
+  EXPECT_EQ(fit_model.predict(xs).mean(), expected);
+  EXPECT_EQ(*m.calls, 3);
+
+  // Each predict type is cached separately.
+  const auto joint = fit_model.predict(xs).joint();
+  EXPECT_EQ(joint.mean, expected);
+  EXPECT_EQ(fit_model.predict(xs).joint(), joint);
+  EXPECT_EQ(*m.calls, 4);
+
+  auto stats = fit_model.prediction_cache_stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.size, 2);
+  EXPECT_EQ(stats.capacity, 2);
+
+  // Different features miss and evict the least recently used entry
+  // which is the mean prediction at xs.
+  fit_model.predict(ys).mean();
+  EXPECT_EQ(*m.calls, 5);
+  fit_model.predict(xs).joint();
+  EXPECT_EQ(*m.calls, 5);
+  fit_model.predict(xs).mean();
+  EXPECT_EQ(*m.calls, 6);
+  EXPECT_EQ(fit_model.prediction_cache_stats().size, 2);
+
+  // Updating the fit invalidates the cache.
+  fit_model.update_in_place(ys, MarginalDistribution(Eigen::VectorXd::Ones(2)));
+  EXPECT_EQ(fit_model.prediction_cache_stats().size, 0);
+  const Eigen::VectorXd updated = fit_model.predict(xs).mean();
+  EXPECT_EQ(*m.calls, 7);
+  EXPECT_EQ(updated, (expected.array() + 1.).matrix());
+
+  // Reading through the mutable accessors keeps the cache.
+  EXPECT_EQ(fit_model.get_fit().offset, 2.);
+  fit_model.get_model();
+  EXPECT_EQ(fit_model.predict(xs).mean(), updated);
+  EXPECT_EQ(*m.calls, 7);
+
+  // Modifying the fit through a reference requires invalidating the
+  // cache explicitly.
+  auto &fit = fit_model.get_fit();
+  fit.offset = 0.;
+  EXPECT_EQ(fit_model.predict(xs).mean(), updated);
+  fit_model.invalidate_prediction_cache();
+  const Eigen::VectorXd before = fit_model.predict(xs).mean();
+  EXPECT_NE(before, updated);
+  EXPECT_EQ(*m.calls, 8);
+  fit.offset = 2.;
+  EXPECT_EQ(fit_model.predict(xs).mean(), before);
+  fit_model.invalidate_prediction_cache();
+  EXPECT_NE(fit_model.predict(xs).mean(), before);
+  EXPECT_EQ(*m.calls, 9);
+
+  fit_model.disable_prediction_cache();
+  fit_model.predict(xs).mean();
+  fit_model.predict(xs).mean();
+  EXPECT_EQ(*m.calls, 11);
+  EXPECT_EQ(fit_model.prediction_cache_stats().size, 0);
+}
+
+struct HashedFeature {
+  int id;
+
+  bool operator==(const HashedFeature &other) const { return id == other.id; }
+};
+
+inline std::size_t hash_value(const HashedFeature &x) {
+  return std::hash<int>()(x.id);
+}
+
+struct UnhashedFeature {
+  int id;
+
+  bool operator==(const UnhashedFeature &other) const {
+    return id == other.id;
+  }
+};
+
+TEST(test_prediction, test_prediction_cache_feature_hash) {
+  EXPECT_TRUE(has_hash_value<HashedFeature>::value);
+  EXPECT_FALSE(has_hash_value<UnhashedFeature>::value);
+  EXPECT_NE(details::feature_hash(HashedFeature{1}),
+            details::feature_hash(HashedFeature{2}));
+  EXPECT_EQ(details::feature_hash(UnhashedFeature{1}),
+            details::feature_hash(UnhashedFeature{2}));
+
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(3, 0., 1.);
+  Eigen::VectorXd y(x);
+  EXPECT_EQ(details::feature_hash(x), details::feature_hash(y));
+  y[1] = 2.;
+  EXPECT_NE(details::feature_hash(x), details::feature_hash(y));
+  EXPECT_NE(details::feature_hash(Eigen::Vector3d(x)),
+            details::feature_hash(Eigen::Vector3d(y)));
+
+  EXPECT_EQ(details::feature_hash(as_measurement(x)),
+            details::feature_hash(x));
+  EXPECT_NE(details::feature_hash(as_measurement(x)),
+            details::feature_hash(as_measurement(y)));
+
+  using Variant = variant<double, HashedFeature>;
+  EXPECT_EQ(details::feature_hash(Variant(1.)),
+            details::feature_hash(Variant(1.)));
+  EXPECT_NE(details::feature_hash(Variant(1.)),
+            details::feature_hash(Variant(2.)));
+  EXPECT_NE(details::feature_hash(Variant(HashedFeature{1})),
+            details::feature_hash(Variant(HashedFeature{2})));
+
+  const std::vector<double> coordinates = {1., 2., 3., 1., 2., 4.};
+  const auto views = coordinate_views(coordinates.data(), 2, 2, 3);
+  const std::vector<double> copy(coordinates);
+  const auto copy_views = coordinate_views(copy.data(), 2, 2, 3);
+  EXPECT_EQ(details::feature_hash(views[0]),
+            details::feature_hash(copy_views[0]));
+  EXPECT_EQ(details::feature_hash(views[0]),
+            details::feature_hash(views[1]));
+}
+
 } // namespace albatross
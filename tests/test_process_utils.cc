@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <albatross/Indexing>
+#include <albatross/utils/ProcessUtils>
+
+namespace albatross {
+
+TEST(test_process_utils, test_process_apply_value_only) {
+  std::map<std::string, int> xs = {{"0", 0}, {"1", 1}, {"2", 2},
+                                   {"3", 3}, {"4", 4}, {"5", 5}};
+
+  auto make_vector = [](const int x) {
+    return Eigen::VectorXd::Constant(x + 1, static_cast<double>(x)).eval();
+  };
+
+  const auto expected = apply(xs, make_vector);
+  for (const std::size_t max_processes : {1, 2, 8}) {
+    EXPECT_EQ(process_apply(xs, make_vector, max_processes), expected);
+  }
+}
+
+TEST(test_process_utils, test_process_apply_key_value) {
+  Grouped<int, std::vector<double>> xs;
+  xs[2] = {1., 2.};
+  xs[4] = {3.};
+  xs[7] = {};
+
+  auto sum_with_key = [](const int key, const std::vector<double> &values) {
+    return std::accumulate(values.begin(), values.end(),
+                           static_cast<double>(key));
+  };
+
+  EXPECT_EQ(process_apply(xs, sum_with_key), xs.apply(sum_with_key));
+}
+
+TEST(test_process_utils, test_process_apply_large_result) {
+  // Large enough that the worker's write would block if the pipe
+  // wasn't drained before waiting on it.
+  const std::map<int, Eigen::Index> sizes = {{0, 1 << 18}, {1, 1 << 17}};
+
+  auto make_large = [](const Eigen::Index n) {
+    return Eigen::VectorXd::LinSpaced(n, 0., 1.).eval();
+  };
+
+  const auto actual = process_apply(sizes, make_large, 2);
+  for (const auto &pair : sizes) {
+    EXPECT_EQ(actual.at(pair.first), make_large(pair.second));
+  }
+}
+
+TEST(test_process_utils, test_process_apply_worker_throws) {
+  const std::map<int, int> xs = {{0, 0}, {1, 1}, {2, 2},
+                                 {3, 3}, {4, 4}, {5, 5}};
+
+  auto fail_on_two = [](const int x) {
+    if (x == 2) {
+      throw std::runtime_error("failed");
+    }
+    return x;
+  };
+
+  EXPECT_THROW(process_apply(xs, fail_on_two, 2), std::runtime_error);
+
+  // None of the workers which were still running should be left behind.
+  EXPECT_EQ(waitpid(-1, nullptr, WNOHANG), -1);
+  EXPECT_EQ(errno, ECHILD);
+}
+
+} // namespace albatross
@@ -104,4 +104,98 @@ TYPED_TEST(CovarianceStateSpaceTester, test_state_space_representation) {
                                             this->test_case.get_tolerance());
 }
 
+template <typename CovFunc>
+void expect_tabulated_matches(const CovFunc &cov_func, double tolerance) {
+  const auto tabulated_cov = tabulated(cov_func, tolerance);
+
+  const auto xs = linspace(0., 30., 301);
+  const auto ys = linspace(0.05, 10.05, 51);
+  const double variance = cov_func(0., 0.);
+
+  const Eigen::MatrixXd expected = cov_func(xs);
+  const Eigen::MatrixXd actual = tabulated_cov(xs);
+  EXPECT_LE((expected - actual).cwiseAbs().maxCoeff(), tolerance * variance);
+
+  const Eigen::MatrixXd expected_cross = cov_func(xs, ys);
+  const Eigen::MatrixXd actual_cross = tabulated_cov(xs, ys);
+  EXPECT_LE((expected_cross - actual_cross).cwiseAbs().maxCoeff(),
+            tolerance * variance);
+
+  EXPECT_NEAR(tabulated_cov(xs[3], ys[7]), cov_func(xs[3], ys[7]),
+              tolerance * variance);
+}
+
+TEST(test_radial, test_tabulated_matches_exact) {
+  expect_tabulated_matches(SquaredExponential<EuclideanDistance>(3., 2.),
+                           1e-10);
+  expect_tabulated_matches(Exponential<EuclideanDistance>(3., 2.), 1e-10);
+  expect_tabulated_matches(SquaredExponential<EuclideanDistance>(0.5, 1.),
+                           1e-6);
+}
+
+TEST(test_radial, test_tabulated_rebuilds_on_set_param) {
+  SquaredExponential<EuclideanDistance> cov_func(3., 2.);
+  auto tabulated_cov = tabulated(cov_func);
+  EXPECT_EQ(tabulated_cov.get_params(), cov_func.get_params());
+
+  cov_func.set_param_value("squared_exponential_length_scale", 7.);
+  cov_func.set_param_value("sigma_squared_exponential", 0.5);
+  tabulated_cov.set_params(cov_func.get_params());
+  EXPECT_EQ(tabulated_cov.get_params(), cov_func.get_params());
+
+  const auto xs = linspace(0., 30., 101);
+  const Eigen::MatrixXd expected = cov_func(xs);
+  const Eigen::MatrixXd actual = tabulated_cov(xs);
+  EXPECT_LE((expected - actual).cwiseAbs().maxCoeff(), 1e-10 * 0.25);
+}
+
+template <typename CovFunc>
+void expect_gram_matches_pairwise(const CovFunc &cov_func,
+                                  Eigen::Index dimension, std::size_t n) {
+  std::default_random_engine gen(2020);
+  std::normal_distribution<double> normal(0., 1.);
+  std::vector<Eigen::VectorXd> xs;
+  for (std::size_t i = 0; i < n; ++i) {
+    // Offset from the origin so the norms are large compared to distances.
+    Eigen::VectorXd x = Eigen::VectorXd::Constant(dimension, 100.);
+    for (Eigen::Index j = 0; j < dimension; ++j) {
+      x[j] += normal(gen);
+    }
+    xs.push_back(x);
+  }
+  const std::vector<Eigen::VectorXd> ys(xs.begin(), xs.begin() + n / 3);
+
+  const Eigen::MatrixXd actual = cov_func(xs);
+  const Eigen::MatrixXd actual_cross = cov_func(xs, ys);
+  EXPECT_EQ(actual, actual.transpose());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    const Eigen::Index ii = static_cast<Eigen::Index>(i);
+    for (std::size_t j = 0; j < xs.size(); ++j) {
+      const Eigen::Index jj = static_cast<Eigen::Index>(j);
+      EXPECT_NEAR(actual(ii, jj), cov_func(xs[i], xs[j]), 1e-9);
+      if (j < ys.size()) {
+        EXPECT_NEAR(actual_cross(ii, jj), cov_func(xs[i], ys[j]), 1e-9);
+      }
+    }
+  }
+}
+
+TEST(test_radial, test_gram_distances_match_pairwise) {
+  const SquaredExponential<EuclideanDistance> squared_exponential(5., 1.);
+  const Exponential<EuclideanDistance> exponential(5., 1.);
+  expect_gram_matches_pairwise(squared_exponential, 16, 60);
+  expect_gram_matches_pairwise(exponential, 16, 60);
+  expect_gram_matches_pairwise(tabulated(squared_exponential), 16, 60);
+  // Below the dimension threshold the pairwise distances are used.
+  expect_gram_matches_pairwise(squared_exponential, 3, 60);
+
+  // Large enough to be split into several blocks.
+  const auto params = get_tuning_parameters();
+  TuningParameters blocked_params(params);
+  blocked_params.threads = 4;
+  set_tuning_parameters(blocked_params);
+  expect_gram_matches_pairwise(squared_exponential, 8, 600);
+  set_tuning_parameters(params);
+}
+
 } // namespace albatross
@@ -190,4 +190,30 @@ TEST(test_outlier, test_ransac_edge_cases) {
             RANSAC_RETURN_CODE_EXCEEDED_MAX_FAILED_CANDIDATES);
 }
 
+TEST(test_outlier, test_ransac_cross_validation_reusing_covariance) {
+  const MakeGaussianProcess test_case;
+  auto dataset = test_case.get_dataset();
+  auto model = test_case.get_model();
+
+  dataset.targets.mean[3] = 400.;
+
+  const DefaultGPRansacStrategy ransac_strategy;
+  const auto ransac_model = model.ransac(ransac_strategy, 1., 3, 3, 20);
+
+  const auto indexer = group_by(dataset, group_by_modulo).indexers();
+  const auto cv = ransac_model.cross_validate();
+  const auto joints =
+      cv.predictions_reusing_covariance<JointDistribution>(dataset, indexer);
+
+  // Identical to running Ransac for each fold from scratch.
+  const auto folds = folds_from_group_indexer(dataset, indexer);
+  EXPECT_EQ(joints.size(), folds.size());
+  for (const auto &pair : folds) {
+    const auto expected = predict_fold(ransac_model, pair.second).joint();
+    EXPECT_LT((joints.at(pair.first).mean - expected.mean).norm(), 1e-6);
+    EXPECT_LT((joints.at(pair.first).covariance - expected.covariance).norm(),
+              1e-6);
+  }
+}
+
 } // namespace albatross
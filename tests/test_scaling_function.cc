@@ -207,4 +207,79 @@ TEST(test_scaling_functions, test_operations) {
   EXPECT_GT(lhs_cov_func(a, a), 0.);
 }
 
+class CountingObliquityScaling : public ScalingFunction {
+public:
+  CountingObliquityScaling() : ScalingFunction(), calls(new std::size_t(0)){};
+
+  std::string get_name() const { return "counting_obliquity_scaling"; }
+
+  double _call_impl(const double &x) const {
+    ++(*calls);
+    return obliquity_function(x);
+  }
+
+  std::shared_ptr<std::size_t> calls;
+};
+
+template <typename CovFunc, typename X>
+Eigen::MatrixXd element_wise_covariance(const CovFunc &cov_func,
+                                        const std::vector<X> &xs) {
+  auto caller = [&](const auto &x, const auto &y) { return cov_func(x, y); };
+  return compute_covariance_matrix(caller, xs);
+}
+
+template <typename CovFunc, typename X, typename Y>
+Eigen::MatrixXd element_wise_covariance(const CovFunc &cov_func,
+                                        const std::vector<X> &xs,
+                                        const std::vector<Y> &ys) {
+  auto caller = [&](const auto &x, const auto &y) { return cov_func(x, y); };
+  return compute_covariance_matrix(caller, xs, ys);
+}
+
+TEST(test_scaling_functions, test_scaled_matrix_assembly) {
+  CountingObliquityScaling scaling_function;
+  ScalingTerm<CountingObliquityScaling> scaling(scaling_function);
+  SquaredExponential<EuclideanDistance> radial(2., 3.);
+  IndependentNoise<double> noise(0.1);
+
+  const auto features = make_attenuation_data().features;
+  const std::vector<double> others = {-0.3, 0.4, 1.7};
+  const std::size_t n = features.size();
+
+  auto rhs_scaled = scaling * radial;
+  *scaling_function.calls = 0;
+  const Eigen::MatrixXd rhs_scaled_cov = rhs_scaled(features);
+  EXPECT_EQ(*scaling_function.calls, n);
+  EXPECT_LE((rhs_scaled_cov - element_wise_covariance(rhs_scaled, features))
+                .norm(),
+            1e-12);
+
+  auto lhs_scaled = radial * scaling;
+  *scaling_function.calls = 0;
+  const Eigen::MatrixXd lhs_scaled_cov = lhs_scaled(features, others);
+  EXPECT_EQ(*scaling_function.calls, n + others.size());
+  EXPECT_LE((lhs_scaled_cov -
+             element_wise_covariance(lhs_scaled, features, others))
+                .norm(),
+            1e-12);
+
+  // Nested scaling terms inside sums should also be assembled from vectors.
+  auto nested = scaling * (scaling * radial) + noise;
+  *scaling_function.calls = 0;
+  const Eigen::MatrixXd nested_cov = nested(features);
+  EXPECT_EQ(*scaling_function.calls, 2 * n);
+  EXPECT_LE((nested_cov - element_wise_covariance(nested, features)).norm(),
+            1e-12);
+
+  // Features without a scaling function are left unscaled.
+  struct X {};
+  const std::vector<X> xs(3);
+  auto partially_scaled = scaling * Constant(2.);
+  const Eigen::MatrixXd partial_cov = partially_scaled(features, xs);
+  EXPECT_LE((partial_cov -
+             element_wise_covariance(partially_scaled, features, xs))
+                .norm(),
+            1e-12);
+}
+
 } // namespace albatross
@@ -266,6 +266,25 @@ struct BlockSymmetricMatrix
   }
 };
 
+struct AppendedBlockSymmetricMatrix
+    : public SerializableType<
+          AppendedBlockSymmetric<Eigen::SerializableLDLT>> {
+
+  RepresentationType create() const override {
+
+    std::default_random_engine gen(2012);
+    const auto X = random_covariance_matrix(6, gen);
+
+    const Eigen::MatrixXd A = X.topLeftCorner(3, 3);
+    AppendedBlockSymmetric<Eigen::SerializableLDLT> output(A.ldlt());
+    output.append(Eigen::MatrixXd::Random(3, 2),
+                  Eigen::SerializableLDLT(X.block(3, 3, 2, 2)));
+    output.append(Eigen::MatrixXd::Random(5, 1),
+                  Eigen::SerializableLDLT(X.bottomRightCorner(1, 1)));
+    return output;
+  }
+};
+
 REGISTER_TYPED_TEST_CASE_P(SerializeTest, test_roundtrip_serialize_json,
                            test_roundtrip_serialize_binary);
 
@@ -275,7 +294,8 @@ typedef ::testing::Types<LDLT, ExplainedCovarianceRepresentation, EigenMatrix3d,
                          FullJointDistribution, FullMarginalDistribution,
                          ParameterStoreType, Dataset, DatasetWithMetadata,
                          SerializableType<MockModel>, VariantAsInt,
-                         VariantAsDouble, BlockSymmetricMatrix>
+                         VariantAsDouble, BlockSymmetricMatrix,
+                         AppendedBlockSymmetricMatrix>
     ToTest;
 
 INSTANTIATE_TYPED_TEST_CASE_P(Albatross, SerializeTest, ToTest);
@@ -414,4 +434,50 @@ TEST(test_serialize, test_gp_serialize_version) {
   EXPECT_EQ(actual_version, expected_version);
 }
 
+TEST(test_serialize, test_gp_fit_delta_log) {
+  auto dataset = make_toy_linear_data();
+  dataset.targets.covariance =
+      0.01 * Eigen::VectorXd::Ones(dataset.size()).asDiagonal();
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const std::vector<std::size_t> first_inds = {0, 1, 2, 3};
+  const std::vector<std::size_t> second_inds = {4, 5, 6};
+  const std::vector<std::size_t> third_inds = {7, 8, 9};
+  const auto first = albatross::subset(dataset, first_inds);
+  const auto second = albatross::subset(dataset, second_inds);
+  const auto third = albatross::subset(dataset, third_inds);
+
+  const auto first_fit = as_appendable_fit(model.fit(first).get_fit());
+  const auto second_fit =
+      model._update_impl(first_fit, second.features, second.targets);
+  const auto third_fit =
+      model._update_impl(second_fit, third.features, third.targets);
+  using FitType = typename std::decay<decltype(first_fit)>::type;
+
+  // Write a snapshot of the first fit and log the two updates.
+  std::ostringstream snapshot;
+  {
+    cereal::BinaryOutputArchive archive(snapshot);
+    archive(first_fit);
+  }
+  std::ostringstream log;
+  append_fit_delta(
+      log, model.update_delta(first_fit, second.features, second.targets));
+  append_fit_delta(
+      log, model.update_delta(second_fit, third.features, third.targets));
+
+  // Loading the snapshot and replaying the log recovers the latest fit.
+  FitType loaded;
+  {
+    std::istringstream snapshot_stream(snapshot.str());
+    cereal::BinaryInputArchive archive(snapshot_stream);
+    archive(loaded);
+  }
+  EXPECT_EQ(loaded, first_fit);
+
+  std::istringstream log_stream(log.str());
+  EXPECT_EQ(replay_fit_deltas(log_stream, &loaded), 2);
+  EXPECT_EQ(loaded, third_fit);
+}
+
 } // namespace albatross
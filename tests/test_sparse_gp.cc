@@ -121,6 +121,19 @@ TYPED_TEST(SparseGaussianProcessTest, test_sanity) {
   expect_sparse_gp_performance(covariance, grouper, 5e-2, 100.);
 }
 
+TYPED_TEST(SparseGaussianProcessTest, test_grouped_joint) {
+  const auto dataset = make_toy_linear_data();
+  const auto covariance = make_simple_covariance_function();
+  UniformlySpacedInducingPoints strategy(8);
+  const auto model =
+      sparse_gp_from_covariance(covariance, this->grouper, strategy, "sparse");
+  const auto fit_model = model.fit(dataset);
+
+  const auto test_features = linspace(-3., 13., 17);
+  expect_grouped_joint_matches_joint(fit_model.predict(test_features),
+                                     test_features, this->grouper);
+}
+
 TYPED_TEST(SparseGaussianProcessTest, test_scales) {
 
   auto grouper = this->grouper;
@@ -305,6 +318,86 @@ TYPED_TEST(SparseGaussianProcessTest, test_update) {
   EXPECT_LT(updated_cov_diff, 1e-6);
 }
 
+TYPED_TEST(SparseGaussianProcessTest, test_update_with_forgetting) {
+  auto grouper = this->grouper;
+  auto covariance = make_simple_covariance_function();
+  auto dataset = make_toy_linear_data();
+
+  const double min =
+      *std::min_element(dataset.features.begin(), dataset.features.end());
+  const double max =
+      *std::max_element(dataset.features.begin(), dataset.features.end());
+
+  FixedInducingPoints strategy(min, max, 8);
+  auto sparse =
+      sparse_gp_from_covariance(covariance, grouper, strategy, "sparse");
+  sparse.set_param(details::inducing_nugget_name(), 1e-3);
+  sparse.set_param(details::measurement_nugget_name(), 1e-12);
+
+  auto groups = dataset.group_by(grouper).groups();
+  const auto held_out_pair = groups.first_group();
+  groups.erase(held_out_pair.first);
+  const auto partial_dataset = groups.combine();
+
+  const auto partial_fit = sparse.fit(partial_dataset);
+  auto full_update = partial_fit;
+  full_update.update_in_place(held_out_pair.second);
+
+  const double lambda = 0.3;
+  auto forgetful = sparse;
+  forgetful.set_forgetting_factor(lambda);
+  EXPECT_EQ(forgetful.get_forgetting_factor(), lambda);
+  auto forgetful_fit = forgetful.fit(partial_dataset);
+  forgetful_fit.update_in_place(held_out_pair.second);
+
+  // The precision is (R P^T)^T (R P^T).
+  auto compute_precision = [](const auto &fit_model) -> Eigen::MatrixXd {
+    const auto &fit = fit_model.get_fit();
+    const Eigen::MatrixXd R =
+        fit.sigma_R.template triangularView<Eigen::Upper>();
+    Eigen::MatrixXd RPt(R.rows(), R.cols());
+    for (Eigen::Index i = 0; i < fit.permutation_indices.size(); ++i) {
+      RPt.col(fit.permutation_indices.coeff(i)) = R.col(i);
+    }
+    return RPt.transpose() * RPt;
+  };
+
+  Eigen::MatrixXd K_uu = covariance(partial_fit.get_fit().train_features);
+  K_uu.diagonal() += 1e-3 * Eigen::VectorXd::Ones(K_uu.rows());
+
+  // Only the contribution of the old data to the precision (and to
+  // P v, the information in the precision's coordinates) is scaled.
+  const Eigen::MatrixXd old_precision = compute_precision(partial_fit);
+  const Eigen::MatrixXd full_precision = compute_precision(full_update);
+  const Eigen::MatrixXd expected_precision =
+      full_precision - (1. - lambda) * (old_precision - K_uu);
+  const Eigen::MatrixXd actual_precision = compute_precision(forgetful_fit);
+  EXPECT_LT((actual_precision - expected_precision).norm(),
+            1e-6 * expected_precision.norm());
+
+  const Eigen::VectorXd expected_Pv =
+      full_precision * full_update.get_fit().information -
+      (1. - lambda) * old_precision * partial_fit.get_fit().information;
+  const Eigen::VectorXd actual_Pv =
+      actual_precision * forgetful_fit.get_fit().information;
+  EXPECT_LT((actual_Pv - expected_Pv).norm(), 1e-6 * expected_Pv.norm());
+
+  // Repeatedly updating with the same data converges to the fit in which
+  // that data was seen once with weight 1 / (1 - lambda) and the old data
+  // has been entirely forgotten, while the size of the fit stays fixed.
+  for (std::size_t i = 0; i < 100; ++i) {
+    forgetful_fit.update_in_place(held_out_pair.second);
+  }
+  EXPECT_EQ(forgetful_fit.get_fit().sigma_R.rows(),
+            partial_fit.get_fit().sigma_R.rows());
+  const Eigen::MatrixXd new_data_precision = full_precision - old_precision;
+  const Eigen::MatrixXd steady_state_precision =
+      K_uu + new_data_precision / (1. - lambda);
+  EXPECT_LT(
+      (compute_precision(forgetful_fit) - steady_state_precision).norm(),
+      1e-6 * steady_state_precision.norm());
+}
+
 TYPED_TEST(SparseGaussianProcessTest, test_rebase_inducing_points) {
   auto grouper = this->grouper;
   auto covariance = make_simple_covariance_function();
@@ -421,4 +514,76 @@ TYPED_TEST(SparseGaussianProcessTest, test_shift_inducing_points) {
   EXPECT_LT((shifted_pred.covariance - full_pred.covariance).norm(), 1e-8);
 }
 
+struct EverythingTogether {
+  int operator()(const double &f) const { return 0; }
+};
+
+struct EachOnItsOwn {
+  double operator()(const double &f) const { return f; }
+};
+
+TEST(test_sparse_gp, test_size_capped_grouper) {
+  const auto features = linspace(0., 9., 10);
+
+  // One big group should be broken up into balanced, contiguous blocks.
+  const auto split = size_capped_grouper(EverythingTogether(), 4);
+  const auto split_indexers = split.indexers(features);
+  EXPECT_EQ(split_indexers.size(), 3);
+  GroupIndices all_indices;
+  for (const auto &pair : split_indexers) {
+    EXPECT_LE(pair.second.size(), 4);
+    EXPECT_GE(pair.second.size(), 3);
+    all_indices.insert(all_indices.end(), pair.second.begin(),
+                       pair.second.end());
+  }
+  std::sort(all_indices.begin(), all_indices.end());
+  EXPECT_EQ(all_indices, GroupIndices({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_EQ(block_size_histogram(split_indexers),
+            (std::map<std::size_t, std::size_t>{{3, 2}, {4, 1}}));
+
+  // Sorting by a reversed order should keep blocks contiguous in that order.
+  const auto reversed = size_capped_grouper(
+      EverythingTogether(), 5, 1, [](const double &f) { return -f; });
+  const auto reversed_indexers = reversed.indexers(features);
+  EXPECT_EQ(reversed_indexers.size(), 2);
+  EXPECT_EQ(reversed_indexers.at(0), GroupIndices({9, 8, 7, 6, 5}));
+
+  // Lots of tiny groups should be merged up to the minimum size.
+  const auto merged = size_capped_grouper(EachOnItsOwn(), 4, 3);
+  const auto merged_indexers = merged.indexers(features);
+  EXPECT_EQ(block_size_histogram(merged_indexers),
+            (std::map<std::size_t, std::size_t>{{1, 1}, {3, 3}}));
+}
+
+TEST(test_sparse_gp, test_size_capped_grouper_fit) {
+  auto covariance = make_simple_covariance_function();
+  auto dataset = make_toy_linear_data();
+
+  UniformlySpacedInducingPoints strategy(8);
+  auto sparse = sparse_gp_from_covariance(covariance, LeaveOneIntervalOut(),
+                                          strategy, "sparse");
+  auto capped = sparse_gp_from_covariance(
+      covariance, size_capped_grouper(LeaveOneIntervalOut(), 5), strategy,
+      "capped");
+
+  // The grouper already produces blocks under the cap so the result
+  // should be identical.
+  const auto test_features = linspace(0.01, 9.9, 11);
+  const auto sparse_pred =
+      sparse.fit(dataset).predict(test_features).joint();
+  const auto capped_pred =
+      capped.fit(dataset).predict(test_features).joint();
+  EXPECT_LT((sparse_pred.mean - capped_pred.mean).norm(), 1e-8);
+
+  auto smaller = sparse_gp_from_covariance(
+      covariance, size_capped_grouper(LeaveOneIntervalOut(), 2), strategy,
+      "smaller");
+  smaller.record_block_size_insights(dataset.features);
+  EXPECT_EQ(smaller.insights["independent_group_block_sizes"], "1:2, 2:4");
+  EXPECT_EQ(smaller.insights["max_independent_group_block_size"], "2");
+  const auto smaller_pred =
+      smaller.fit(dataset).predict(test_features).joint();
+  EXPECT_LT((sparse_pred.mean - smaller_pred.mean).norm(), 0.1);
+}
+
 } // namespace albatross
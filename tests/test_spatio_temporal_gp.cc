@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <albatross/SpatioTemporalGP>
+
+namespace albatross {
+
+inline auto make_spatial_covariance() {
+  SquaredExponential<EuclideanDistance> squared_exponential(2., 1.);
+  IndependentNoise<double> noise(0.1);
+  return squared_exponential + measurement_only(noise);
+}
+
+/*
+ * Observations from a network of stations at irregularly spaced epochs
+ * where not every station reports at every epoch.
+ */
+inline RegressionDataset<SpaceTimeFeature<double>> make_station_data() {
+  const std::vector<double> stations = {0., 1.5, 3., 4.5};
+  const std::vector<double> times = {0., 0.4, 1., 1.3, 2.5, 2.6, 3.5};
+
+  std::vector<SpaceTimeFeature<double>> features;
+  std::vector<double> targets;
+  std::size_t count = 0;
+  for (const auto &time : times) {
+    for (const auto &station : stations) {
+      ++count;
+      if (count % 5 == 0) {
+        continue;
+      }
+      features.emplace_back(time, station);
+      targets.push_back(sin(station) + cos(2. * time) +
+                        0.05 * static_cast<double>(count % 3));
+    }
+  }
+  Eigen::VectorXd target_vector(static_cast<Eigen::Index>(targets.size()));
+  for (std::size_t i = 0; i < targets.size(); ++i) {
+    target_vector[static_cast<Eigen::Index>(i)] = targets[i];
+  }
+  return RegressionDataset<SpaceTimeFeature<double>>(features, target_vector);
+}
+
+template <typename CovFunc, typename TemporalProcess>
+Eigen::MatrixXd
+dense_covariance(const CovFunc &cov, const TemporalProcess &temporal,
+                 const std::vector<SpaceTimeFeature<double>> &xs,
+                 const std::vector<SpaceTimeFeature<double>> &ys) {
+  Eigen::MatrixXd output(xs.size(), ys.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    for (std::size_t j = 0; j < ys.size(); ++j) {
+      output(i, j) = temporal_correlation(temporal, xs[i].time - ys[j].time) *
+                     cov(xs[i].space, ys[j].space);
+    }
+  }
+  return output;
+}
+
+inline std::vector<SpaceTimeFeature<double>> make_test_features() {
+  std::vector<SpaceTimeFeature<double>> features;
+  // Before, during, between and after the epochs, at and between
+  // the stations.
+  for (const double time : {-0.5, 0., 0.7, 1.3, 3., 3.5, 4.2}) {
+    for (const double station : {0., 0.8, 3., 5.}) {
+      features.emplace_back(time, station);
+    }
+  }
+  return features;
+}
+
+template <typename TemporalProcess, typename ModelType>
+void expect_matches_dense_gp(const TemporalProcess &temporal,
+                             const ModelType &model) {
+  const auto dataset = make_station_data();
+  const auto cov = make_spatial_covariance();
+
+  Eigen::MatrixXd K =
+      dense_covariance(cov, temporal, dataset.features, dataset.features);
+  K.diagonal() += 0.01 * Eigen::VectorXd::Ones(K.rows());
+  const auto K_ldlt = K.ldlt();
+
+  const auto test_features = make_test_features();
+  const Eigen::MatrixXd cross =
+      dense_covariance(cov, temporal, test_features, dataset.features);
+  const Eigen::VectorXd expected_mean =
+      cross * K_ldlt.solve(dataset.targets.mean);
+  const Eigen::VectorXd expected_variance =
+      dense_covariance(cov, temporal, test_features, test_features)
+          .diagonal() -
+      (cross * K_ldlt.solve(cross.transpose())).diagonal();
+
+  const auto pred = model.fit(dataset).predict(test_features).marginal();
+  EXPECT_LT((pred.mean - expected_mean).norm(), 1e-6);
+  EXPECT_LT((pred.covariance.diagonal() - expected_variance).norm(), 1e-6);
+
+  const double expected_ll =
+      -negative_log_likelihood(dataset.targets.mean, K);
+  EXPECT_NEAR(model.log_likelihood(dataset), expected_ll,
+              1e-6 * fabs(expected_ll));
+}
+
+TEST(test_spatio_temporal_gp, test_temporal_correlation) {
+  const ExponentialTemporalProcess exponential(2.);
+  const Matern32TemporalProcess matern(2.);
+  for (const double dt : {0., 0.3, -1., 4.}) {
+    const double r = fabs(dt) / 2.;
+    EXPECT_NEAR(temporal_correlation(exponential, dt), exp(-r), 1e-12);
+    EXPECT_NEAR(temporal_correlation(matern, dt),
+                (1. + sqrt(3.) * r) * exp(-sqrt(3.) * r), 1e-12);
+  }
+}
+
+TEST(test_spatio_temporal_gp, test_matches_dense_gp) {
+  const auto cov = make_spatial_covariance();
+
+  const ExponentialTemporalProcess exponential(1.5);
+  expect_matches_dense_gp(exponential, spatio_temporal_gp(cov, exponential));
+
+  const Matern32TemporalProcess matern(1.5);
+  expect_matches_dense_gp(matern, spatio_temporal_gp(cov, matern));
+}
+
+struct StationsAndMidpoints {
+  template <typename CovFunc>
+  std::vector<double> operator()(const CovFunc &,
+                                 const std::vector<double> &) const {
+    return {0., 0.75, 1.5, 2.25, 3., 3.75, 4.5};
+  }
+};
+
+TEST(test_spatio_temporal_gp, test_state_feature_strategy) {
+  // With state features that include all the stations the model
+  // is still exact.
+  const auto cov = make_spatial_covariance();
+  const Matern32TemporalProcess matern(1.5);
+  const auto model =
+      spatio_temporal_gp(cov, matern, StationsAndMidpoints());
+  expect_matches_dense_gp(matern, model);
+  EXPECT_EQ(model.fit(make_station_data()).get_fit().state_features.size(),
+            7);
+}
+
+TEST(test_spatio_temporal_gp, test_online_update) {
+  const auto cov = make_spatial_covariance();
+  const Matern32TemporalProcess matern(1.5);
+  const auto model = spatio_temporal_gp(cov, matern);
+  const auto dataset = make_station_data();
+
+  using FitType =
+      typename fit_type<decltype(model), SpaceTimeFeature<double>>::type;
+  EXPECT_TRUE(bool(has_valid_update_in_place<decltype(model), FitType,
+                                             SpaceTimeFeature<double>>::value));
+
+  auto get_time = [](const auto &f) { return f.time; };
+  const auto epochs = dataset.group_by(get_time).groups();
+
+  auto online_fit = model.fit(epochs.first_value());
+  auto copied_fit = online_fit;
+  bool first = true;
+  for (const auto &pair : epochs) {
+    if (first) {
+      first = false;
+      continue;
+    }
+    online_fit.update_in_place(pair.second);
+    copied_fit = copied_fit.update(pair.second);
+  }
+
+  const auto full_fit = model.fit(dataset);
+  EXPECT_EQ(online_fit.get_fit().times, full_fit.get_fit().times);
+  EXPECT_EQ(online_fit.get_fit(), copied_fit.get_fit());
+
+  const auto test_features = make_test_features();
+  const auto online_pred = online_fit.predict(test_features).marginal();
+  const auto full_pred = full_fit.predict(test_features).marginal();
+  EXPECT_LT((online_pred.mean - full_pred.mean).norm(), 1e-10);
+  EXPECT_LT((online_pred.covariance.diagonal() -
+             full_pred.covariance.diagonal())
+                .norm(),
+            1e-10);
+
+  // An epoch can be split across updates, though the state features
+  // are determined by the initial fit.
+  const auto fixed_model =
+      spatio_temporal_gp(cov, matern, StationsAndMidpoints());
+  const auto first_epoch = epochs.first_value();
+  std::vector<std::size_t> rest(first_epoch.size() - 1);
+  std::iota(rest.begin(), rest.end(), 1);
+  auto split_fit =
+      fixed_model.fit(subset(first_epoch, std::vector<std::size_t>{0}));
+  split_fit.update_in_place(subset(first_epoch, rest));
+  const auto whole_fit = fixed_model.fit(first_epoch);
+  ASSERT_EQ(split_fit.get_fit().times.size(), 1);
+  EXPECT_LT((split_fit.get_fit().means[0] - whole_fit.get_fit().means[0])
+                .norm(),
+            1e-8);
+  EXPECT_LT((split_fit.get_fit().covariances[0] -
+             whole_fit.get_fit().covariances[0])
+                .norm(),
+            1e-8);
+}
+
+} // namespace albatross
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "test_models.h"
+
+#include <albatross/Thinning>
+
+namespace albatross {
+
+// Repeatedly observes the same handful of locations.
+inline RegressionDataset<double> make_redundant_data(std::size_t repeats) {
+  const auto base = make_toy_linear_data(5., 1., 0.1, 10);
+  const Eigen::Index n = static_cast<Eigen::Index>(base.size());
+  std::default_random_engine gen(2012);
+  std::normal_distribution<double> noise(0., 0.1);
+
+  std::vector<double> features;
+  Eigen::VectorXd mean(n * static_cast<Eigen::Index>(repeats));
+  Eigen::VectorXd variance(mean.size());
+  for (Eigen::Index r = 0; r < static_cast<Eigen::Index>(repeats); ++r) {
+    for (Eigen::Index i = 0; i < n; ++i) {
+      features.push_back(base.features[static_cast<std::size_t>(i)]);
+      mean[r * n + i] = base.targets.mean[i] + noise(gen);
+      variance[r * n + i] = 0.01 * static_cast<double>(1 + (r % 3));
+    }
+  }
+  return RegressionDataset<double>(features,
+                                   MarginalDistribution(mean, variance));
+}
+
+TEST(test_thinning, test_aggregate_duplicates) {
+  const auto dataset = make_redundant_data(6);
+  // Without measurement noise in the covariance function combining
+  // identical observations leaves the posterior unchanged.
+  const auto model = gp_from_covariance(
+      SquaredExponential<EuclideanDistance>(100., 100.), "direct");
+
+  const auto grouper = [](const double &x) { return std::lround(x); };
+  const auto thinned_model =
+      model.thinned(aggregate_duplicates_thinning(grouper));
+
+  const auto reduced = thinned_model.thin(dataset);
+  EXPECT_EQ(reduced.size(), 10);
+
+  const auto fit_model = thinned_model.fit(dataset);
+  const auto summary = fit_model.get_fit().summary;
+  EXPECT_EQ(summary.input_size, dataset.size());
+  EXPECT_EQ(summary.output_size, 10);
+  EXPECT_NEAR(summary.reduction(), 1. - 1. / 6., 1e-12);
+  EXPECT_EQ(summary.insights().at("output_size"), "10");
+
+  const auto test_features = linspace(-2., 12., 15);
+  const auto expected = model.fit(dataset).predict(test_features).joint();
+  const auto actual = fit_model.predict(test_features).joint();
+  EXPECT_LT((expected.mean - actual.mean).norm(), 1e-6);
+  EXPECT_LT((expected.covariance - actual.covariance).norm(), 1e-6);
+}
+
+TEST(test_thinning, test_greedy_information_gain) {
+  // Sampled densely relative to the length scale of the covariance.
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 200);
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const auto thinned_model =
+      model.thinned(GreedyInformationGainThinning(0.1, 1000));
+  const auto fit_model = thinned_model.fit(dataset);
+  const auto summary = fit_model.get_fit().summary;
+  EXPECT_EQ(summary.input_size, 200);
+  EXPECT_LT(summary.output_size, 50);
+  EXPECT_GT(summary.output_size, 0);
+
+  const auto test_features = linspace(0., 200., 21);
+  const auto expected = model.fit(dataset).predict(test_features).marginal();
+  const auto actual = fit_model.predict(test_features).marginal();
+  EXPECT_LT((expected.mean - actual.mean).norm(),
+            1e-2 * expected.mean.norm());
+
+  // The size cap is respected and smaller tolerances keep more data.
+  const auto capped = model.thinned(GreedyInformationGainThinning(0., 5));
+  EXPECT_EQ(capped.thin(dataset).size(), 5);
+  const auto strict = model.thinned(GreedyInformationGainThinning(1e-2, 200));
+  EXPECT_GT(strict.thin(dataset).size(), summary.output_size);
+}
+
+TEST(test_thinning, test_greedy_information_gain_default) {
+  // The default size cap is unbounded so the factor has to grow with
+  // the number of points selected rather than being preallocated.
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 200);
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const auto thinned_model = model.thinned(GreedyInformationGainThinning());
+  const auto reduced = thinned_model.thin(dataset);
+  EXPECT_GT(reduced.size(), 16);
+  EXPECT_LE(reduced.size(), dataset.size());
+
+  const auto test_features = linspace(0., 200., 21);
+  const auto expected = model.fit(dataset).predict(test_features).marginal();
+  const auto actual = thinned_model.fit(dataset).predict(test_features);
+  EXPECT_LT((expected.mean - actual.marginal().mean).norm(),
+            1e-2 * expected.mean.norm());
+}
+
+TEST(test_thinning, test_chained) {
+  const auto dataset = make_redundant_data(6);
+  const auto model = gp_from_covariance(make_simple_covariance_function());
+
+  const auto grouper = [](const double &x) { return std::lround(x); };
+  const auto aggregate = aggregate_duplicates_thinning(grouper);
+  const auto chained = model.thinned(
+      chain_thinning(aggregate, GreedyInformationGainThinning(0., 4)));
+
+  const auto reduced = chained.thin(dataset);
+  EXPECT_EQ(reduced.size(), 4);
+  for (const auto &f : reduced.features) {
+    EXPECT_TRUE(std::find(dataset.features.begin(), dataset.features.end(),
+                          f) != dataset.features.end());
+  }
+}
+
+} // namespace albatross
@@ -148,6 +148,20 @@ TEST(test_traits_core, test_is_measurement) {
   EXPECT_FALSE(is_measurement<variant<double>>::value);
 }
 
+struct Comparable {
+  bool operator==(const Comparable &) const { return true; }
+};
+
+TEST(test_traits_core, test_is_equality_comparable) {
+  struct X {};
+
+  EXPECT_TRUE(bool(is_equality_comparable<double>::value));
+  EXPECT_TRUE(bool(is_equality_comparable<Comparable>::value));
+  EXPECT_FALSE(bool(is_equality_comparable<X>::value));
+  EXPECT_TRUE(bool(is_equality_comparable<variant<double, Comparable>>::value));
+  EXPECT_FALSE(bool(is_equality_comparable<variant<double, X>>::value));
+}
+
 class Complete {};
 
 class Incomplete;
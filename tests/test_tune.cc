@@ -178,4 +178,41 @@ TEST(test_tune, test_generic) {
   EXPECT_LT((eigen_param_output - truth).norm(), 1e-4);
 }
 
+TEST(test_tune, test_multi_fidelity) {
+  const MakeGaussianProcess test_case;
+  auto model = test_case.get_model();
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 100);
+
+  LeaveOneOutLikelihood<> loo_nll;
+  std::ostringstream output_stream;
+
+  MultiFidelityConfig config;
+  config.num_candidates = 9;
+  config.initial_fraction = 0.1;
+  config.polish_evaluations = 10;
+  auto tuner = get_multi_fidelity_tuner(model, loo_nll, dataset, config,
+                                        RandomSubset(), output_stream);
+  const auto params = tuner.tune();
+
+  const double initial_score = loo_nll(dataset, model);
+  model.set_params(params);
+  EXPECT_TRUE(model.params_are_valid());
+  EXPECT_LT(loo_nll(dataset, model), initial_score);
+}
+
+TEST(test_tune, test_stratified_subset) {
+  const auto dataset = make_toy_linear_data(5., 1., 0.1, 100);
+  auto grouper = [](const double &f) { return f < 20.; };
+
+  std::default_random_engine gen(2012);
+  const auto subset = stratified_subset(grouper)(dataset, 0.1, gen);
+  EXPECT_EQ(subset.size(), 10);
+  const auto counts = subset.group_by(grouper).counts();
+  EXPECT_EQ(counts.at(true), 2);
+  EXPECT_EQ(counts.at(false), 8);
+
+  EXPECT_EQ(RandomSubset()(dataset, 0.25, gen).size(), 25);
+  EXPECT_EQ(RandomSubset()(dataset, 1., gen), dataset);
+}
+
 } // namespace albatross
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2020 Swift Navigation Inc.
+ * Contact: Swift Navigation <dev@swiftnav.com>
+ *
+ * This source is subject to the license found in the file 'LICENSE' which must
+ * be distributed together with this source. All other rights reserved.
+ *
+ * THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND,
+ * EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+
+#include <albatross/CovarianceFunctions>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <thread>
+
+namespace albatross {
+
+inline std::string temporary_tuning_cache() {
+  const std::string path = "test_tuning_cache.txt";
+  std::remove(path.c_str());
+  return path;
+}
+
+TEST(test_tuning, test_cache_round_trip) {
+  const auto path = temporary_tuning_cache();
+  TuningParameters params;
+  EXPECT_FALSE(read_tuning_cache(path, "cpu a", &params));
+
+  TuningParameters a;
+  a.gram_distance_dimension = 16;
+  a.parallel_block_size = 1 << 12;
+  a.threads = 3;
+  TuningParameters b;
+  b.threads = 7;
+  ASSERT_TRUE(write_tuning_cache(path, "cpu a", a));
+  ASSERT_TRUE(write_tuning_cache(path, "cpu b", b));
+  EXPECT_TRUE(read_tuning_cache(path, "cpu a", &params));
+  EXPECT_EQ(params, a);
+  EXPECT_TRUE(read_tuning_cache(path, "cpu b", &params));
+  EXPECT_EQ(params, b);
+
+  // Replacing one entry leaves the others.
+  a.threads = 1;
+  ASSERT_TRUE(write_tuning_cache(path, "cpu a", a));
+  EXPECT_TRUE(read_tuning_cache(path, "cpu a", &params));
+  EXPECT_EQ(params, a);
+  EXPECT_TRUE(read_tuning_cache(path, "cpu b", &params));
+  EXPECT_EQ(params, b);
+  EXPECT_FALSE(read_tuning_cache(path, "cpu c", &params));
+  std::remove(path.c_str());
+}
+
+TEST(test_tuning, test_cache_creates_directories) {
+  const std::string directory = "test_tuning_cache_dir";
+  const std::string path = directory + "/nested/albatross_tuning.txt";
+  std::remove(path.c_str());
+
+  TuningParameters params;
+  params.threads = 5;
+  ASSERT_TRUE(write_tuning_cache(path, "cpu a", params));
+  TuningParameters cached;
+  EXPECT_TRUE(read_tuning_cache(path, "cpu a", &cached));
+  EXPECT_EQ(cached, params);
+
+  std::remove(path.c_str());
+  rmdir((directory + "/nested").c_str());
+  rmdir(directory.c_str());
+}
+
+TEST(test_tuning, test_auto_tuning_uses_cache) {
+  const auto original = get_tuning_parameters();
+  const auto path = temporary_tuning_cache();
+
+  TuningParameters calibrated;
+  calibrated.gram_distance_dimension = 32;
+  calibrated.threads = 2;
+  std::size_t calls = 0;
+  const auto calibrate = [&]() {
+    ++calls;
+    return calibrated;
+  };
+
+  // Calibration only happens once it is needed and is then persisted.
+  enable_auto_tuning(calibrate, path);
+  EXPECT_EQ(calls, 0);
+  EXPECT_EQ(get_tuning_parameters(), calibrated);
+  EXPECT_EQ(get_tuning_parameters(), calibrated);
+  EXPECT_EQ(calls, 1);
+
+  set_tuning_parameters(original);
+  enable_auto_tuning(calibrate, path);
+  EXPECT_EQ(get_tuning_parameters(), calibrated);
+  EXPECT_EQ(calls, 1);
+
+  // Explicitly set parameters take precedence.
+  enable_auto_tuning(calibrate, path);
+  set_tuning_parameters(original);
+  EXPECT_EQ(get_tuning_parameters(), original);
+  EXPECT_EQ(calls, 1);
+  std::remove(path.c_str());
+}
+
+TEST(test_tuning, test_auto_tuning_assembles_covariance) {
+  const auto original = get_tuning_parameters();
+  const auto path = temporary_tuning_cache();
+
+  // A calibration which times real assembly requests the (not yet
+  // resolved) parameters itself.
+  std::vector<Eigen::VectorXd> xs;
+  for (std::size_t i = 0; i < 20; ++i) {
+    xs.push_back(Eigen::VectorXd::Constant(16, static_cast<double>(i)));
+  }
+  const SquaredExponential<EuclideanDistance> cov_func(3., 1.);
+  TuningParameters calibrated;
+  calibrated.gram_distance_dimension = 4;
+  std::size_t calls = 0;
+  const auto calibrate = [&]() {
+    ++calls;
+    EXPECT_EQ(cov_func(xs).rows(), 20);
+    return calibrated;
+  };
+
+  enable_auto_tuning(calibrate, path);
+  EXPECT_EQ(get_tuning_parameters(), calibrated);
+  EXPECT_EQ(calls, 1);
+
+  set_tuning_parameters(original);
+  std::remove(path.c_str());
+}
+
+TEST(test_tuning, test_concurrent_access) {
+  const auto original = get_tuning_parameters();
+  const auto path = temporary_tuning_cache();
+  // Readers see these until calibration has finished.
+  TuningParameters initial;
+  initial.gram_distance_dimension = 10;
+  initial.parallel_block_size = 10;
+  initial.threads = 10;
+  set_tuning_parameters(initial);
+  TuningParameters calibrated;
+  calibrated.gram_distance_dimension = 11;
+  calibrated.parallel_block_size = 11;
+  calibrated.threads = 11;
+  std::atomic<std::size_t> calls(0);
+  enable_auto_tuning(
+      [&]() {
+        ++calls;
+        return calibrated;
+      },
+      path);
+
+  // Readers should always see one of the parameter sets which were set
+  // as a whole and pending auto tuning is resolved exactly once.
+  std::atomic<bool> consistent(true);
+  std::vector<std::thread> readers;
+  for (std::size_t i = 0; i < 4; ++i) {
+    readers.emplace_back([&consistent]() {
+      for (std::size_t j = 0; j < 1000; ++j) {
+        const auto params = get_tuning_parameters();
+        if (params.parallel_block_size !=
+                static_cast<Eigen::Index>(params.threads) ||
+            params.gram_distance_dimension != params.parallel_block_size) {
+          consistent = false;
+        }
+      }
+    });
+  }
+  for (std::size_t i = 0; i < 100; ++i) {
+    TuningParameters params;
+    params.gram_distance_dimension = static_cast<Eigen::Index>(i + 12);
+    params.parallel_block_size = static_cast<Eigen::Index>(i + 12);
+    params.threads = i + 12;
+    set_tuning_parameters(params);
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_TRUE(consistent);
+  EXPECT_LE(calls, 1);
+
+  set_tuning_parameters(original);
+  std::remove(path.c_str());
+}
+
+TEST(test_tuning, test_calibrate) {
+  CalibrationOptions options;
+  options.size = 64;
+  options.repeats = 1;
+  options.dimensions = {4, 32};
+  options.block_sizes = {1 << 10, 1 << 12};
+  const auto params = calibrate_tuning_parameters(options);
+  EXPECT_GE(params.gram_distance_dimension, 4);
+  EXPECT_TRUE(params.parallel_block_size == (1 << 10) ||
+              params.parallel_block_size == (1 << 12) ||
+              params.parallel_block_size ==
+                  TuningParameters().parallel_block_size);
+  EXPECT_LE(params.threads, tuning_threads(TuningParameters()));
+}
+
+TEST(test_tuning, test_lower_triangle_blocks) {
+  ASSERT_FALSE(deterministic_execution());
+  TuningParameters params;
+  params.threads = 3;
+  params.parallel_block_size = 1;
+  EXPECT_EQ(tuned_column_blocks(100, 100, params).size(), 3);
+  // Workers pick up several blocks each when the work is uneven.
+  EXPECT_EQ(tuned_column_blocks(100, 100, params, true).size(),
+            3 * lower_triangle_blocks_per_thread);
+  // But blocks never get smaller than the block size.
+  params.parallel_block_size = 2000;
+  EXPECT_EQ(tuned_column_blocks(100, 100, params, true).size(), 5);
+}
+
+TEST(test_tuning, test_deterministic_execution) {
+  const auto original = get_tuning_parameters();
+  std::default_random_engine gen(2020);
+  std::normal_distribution<double> normal(0., 1.);
+  std::vector<Eigen::VectorXd> xs;
+  for (std::size_t i = 0; i < 500; ++i) {
+    Eigen::VectorXd x(12);
+    for (Eigen::Index j = 0; j < x.size(); ++j) {
+      x[j] = normal(gen);
+    }
+    xs.push_back(x);
+  }
+  const std::vector<Eigen::VectorXd> ys(xs.begin(), xs.begin() + 7);
+  const SquaredExponential<EuclideanDistance> cov_func(3., 1.);
+
+  set_deterministic_execution(true);
+  TuningParameters params;
+  params.threads = 1;
+  set_tuning_parameters(params);
+  const Eigen::MatrixXd expected = cov_func(xs);
+  const Eigen::MatrixXd expected_cross = cov_func(xs, ys);
+
+  // Neither the thread count nor parameters which would change the
+  // arithmetic have any effect on the results.
+  for (const std::size_t threads : {2, 3, 7}) {
+    params.threads = threads;
+    params.parallel_block_size = 1 << 10;
+    params.gram_distance_dimension = 64;
+    set_tuning_parameters(params);
+    EXPECT_EQ(cov_func(xs), expected);
+    EXPECT_EQ(cov_func(xs, ys), expected_cross);
+  }
+
+  set_deterministic_execution(false);
+  EXPECT_FALSE(deterministic_execution());
+  EXPECT_EQ(get_tuning_parameters(), params);
+  set_tuning_parameters(original);
+}
+
+} // namespace albatross
@@ -185,6 +185,25 @@ void expect_state_space_representation_quality(
   EXPECT_LT(posterior.norm() / full_cov.norm(), threshold);
 }
 
+template <typename PredictionType, typename FeatureType,
+          typename GrouperFunction>
+void expect_grouped_joint_matches_joint(
+    const PredictionType &prediction, const std::vector<FeatureType> &features,
+    const GrouperFunction &grouper) {
+  const JointDistribution joint = prediction.joint();
+  const auto grouped = prediction.grouped_joint(grouper);
+  const auto indexers = group_by(features, grouper).indexers();
+
+  EXPECT_EQ(grouped.keys(), indexers.keys());
+  for (const auto &pair : indexers) {
+    const auto &block = grouped.at(pair.first);
+    const auto expected = subset(joint, pair.second);
+    EXPECT_LT((block.mean - expected.mean).norm(), 1e-8);
+    EXPECT_LT((block.covariance - expected.covariance).norm(),
+              1e-8 * expected.covariance.norm());
+  }
+}
+
 } // namespace albatross
 
 #endif